@@ -0,0 +1,364 @@
+/*
+  Brainlearn, a UCI chess playing engine derived from Stockfish
+  Copyright (C) 2004-2024 Andrea Manzo, K.Kiniama and Brainlearn developers (see AUTHORS file)
+
+  Brainlearn is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Brainlearn is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "analysis.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "../memory.h"
+#include "../misc.h"
+#include "../position.h"
+#include "../search.h"
+#include "../ucioption.h"
+
+namespace Brainlearn::Analysis {
+
+namespace {
+
+constexpr char     Magic[4] = {'M', 'K', 'A', 'C'};
+constexpr uint32_t Version  = 1;
+
+struct StoredMove {
+    Value             score, averageScore;
+    int               selDepth;
+    std::vector<Move> pv;
+};
+
+struct Entry {
+    Depth                   depth;
+    uint64_t                lastUsed;
+    std::vector<StoredMove> moves;
+};
+
+std::mutex                     Mutex;
+std::unordered_map<Key, Entry> Cache;
+std::string                    FileName;
+size_t                         Capacity = 0;  // Zero when the cache is disabled
+size_t                         Records  = 0;  // Records in the file, live or not
+uint64_t                       Tick     = 0;
+
+// The scores depend on the networks and on the search settings, which are
+// hashed into the key. FNV-1a is used because the keys are persisted.
+Key key(const Position& pos, const OptionsMap& options) {
+
+    // The cascade thresholds only matter, and so only change the key, when the
+    // cascade is on
+    const std::string cascade =
+      bool(options["Cascaded Eval"])
+        ? "1," + std::to_string(int(options["Cascaded Eval Margin"])) + ","
+            + std::to_string(int(options["Cascaded Eval Complexity"]))
+        : "0";
+
+    const std::string settings = std::string(options["EvalFile"]) + "|"
+                               + std::string(options["EvalFileSmall"]) + "|" + cascade + "|"
+                               + std::to_string(int(options["MultiPV"])) + "|"
+                               + std::to_string(int(options["Skill Level"])) + "|"
+                               + std::to_string(int(options["UCI_LimitStrength"])) + "|"
+                               + std::to_string(int(options["UCI_Elo"])) + "|"
+                               + std::to_string(MakrukOnly ? 0 : int(options["UCI_Chess960"]));
+
+    uint64_t h = 14695981039346656037ULL;
+    for (char c : settings)
+        h = (h ^ uint8_t(c)) * 1099511628211ULL;
+
+    return pos.key() ^ h;
+}
+
+// Near a draw by the counting rules or by the 50-move rule the results depend on
+// the exact number of plies left, which the key only folds in by buckets (see
+// Position::adjust_key()), so such positions are neither probed nor stored.
+bool near_draw(const Position& pos) { return pos.draw_horizon() <= 86; }
+
+// The size of an entry with its PVs and its node in the hash table
+int64_t bytes(const Entry& e) {
+
+    size_t b = sizeof(Key) + sizeof(Entry) + 2 * sizeof(void*);
+    for (const StoredMove& sm : e.moves)
+        b += sizeof(StoredMove) + sm.pv.size() * sizeof(Move);
+
+    return int64_t(b);
+}
+
+void insert(Key k, const Entry& e) {
+
+    auto it = Cache.find(k);
+    if (it != Cache.end())
+        Memory::add(Memory::ANALYSIS_CACHE, -bytes(it->second));
+
+    Memory::add(Memory::ANALYSIS_CACHE, bytes(e));
+    Cache[k] = e;
+}
+
+template<typename T>
+void write(std::ostream& out, T value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T>
+T read(std::istream& in) {
+    T value{};
+    in.read(reinterpret_cast<char*>(&value), sizeof(T));
+    return value;
+}
+
+void write_record(std::ostream& out, Key k, const Entry& e) {
+
+    write<uint64_t>(out, k);
+    write<int16_t>(out, int16_t(e.depth));
+    write<uint8_t>(out, uint8_t(e.moves.size()));
+
+    for (const StoredMove& sm : e.moves)
+    {
+        write<int16_t>(out, int16_t(sm.score));
+        write<int16_t>(out, int16_t(sm.averageScore));
+        write<uint8_t>(out, uint8_t(sm.selDepth));
+        write<uint8_t>(out, uint8_t(sm.pv.size()));
+        for (Move m : sm.pv)
+            write<uint16_t>(out, m.raw());
+    }
+}
+
+bool read_record(std::istream& in, Key& k, Entry& e) {
+
+    k       = read<uint64_t>(in);
+    e.depth = read<int16_t>(in);
+    e.moves.resize(read<uint8_t>(in));
+
+    for (StoredMove& sm : e.moves)
+    {
+        sm.score        = read<int16_t>(in);
+        sm.averageScore = read<int16_t>(in);
+        sm.selDepth     = read<uint8_t>(in);
+        sm.pv.resize(read<uint8_t>(in));
+        for (Move& m : sm.pv)
+            m = Move(read<uint16_t>(in));
+    }
+
+    return bool(in);
+}
+
+void write_header(std::ostream& out) {
+    out.write(Magic, sizeof(Magic));
+    write<uint32_t>(out, Version);
+}
+
+// Evicts the least recently used eighth of the entries when the cache is full
+void evict() {
+
+    if (Cache.size() <= Capacity)
+        return;
+
+    std::vector<uint64_t> ticks;
+    ticks.reserve(Cache.size());
+    for (const auto& [k, e] : Cache)
+        ticks.push_back(e.lastUsed);
+
+    const size_t n = Cache.size() - Capacity + Capacity / 8;
+    std::nth_element(ticks.begin(), ticks.begin() + n - 1, ticks.end());
+    const uint64_t oldest = ticks[n - 1];
+
+    for (auto it = Cache.begin(); it != Cache.end();)
+        if (it->second.lastUsed <= oldest)
+        {
+            Memory::add(Memory::ANALYSIS_CACHE, -bytes(it->second));
+            it = Cache.erase(it);
+        }
+        else
+            ++it;
+}
+
+// Rewrites the file with the live entries only, through a temporary file so
+// that an interrupted write does not lose the cache.
+void compact() {
+
+    if (Records <= 2 * Cache.size() + 1024)
+        return;
+
+    const std::string tmp = FileName + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out)
+            return;
+
+        write_header(out);
+        for (const auto& [k, e] : Cache)
+            write_record(out, k, e);
+
+        if (!out)
+            return;
+    }
+
+    std::remove(FileName.c_str());
+    if (std::rename(tmp.c_str(), FileName.c_str()))
+        return;
+
+    Records = Cache.size();
+}
+
+void load() {
+
+    std::ifstream in(FileName, std::ios::binary);
+
+    if (!in)
+        return;
+
+    char magic[sizeof(Magic)];
+    in.read(magic, sizeof(magic));
+
+    if (!in || !std::equal(magic, magic + sizeof(Magic), Magic) || read<uint32_t>(in) != Version)
+    {
+        sync_cout << "info string " << FileName << " is not an analysis cache file" << sync_endl;
+        return;
+    }
+
+    Key   k;
+    Entry e;
+
+    while (read_record(in, k, e))
+    {
+        e.lastUsed = ++Tick;
+        insert(k, e);
+        ++Records;
+    }
+}
+
+}  // namespace
+
+void init(const OptionsMap& options) {
+
+    std::lock_guard<std::mutex> lk(Mutex);
+
+    Cache.clear();
+    Memory::set(Memory::ANALYSIS_CACHE, 0);
+    Records = 0;
+    Tick    = 0;
+
+    if (!bool(options["Analysis Cache"]))
+    {
+        Capacity = 0;
+        return;
+    }
+
+    FileName = std::string(options["Analysis Cache File"]);
+    Capacity = size_t(int(options["Analysis Cache Entries"]));
+
+    load();
+    evict();
+    compact();
+
+    sync_cout << "info string analysis cache " << FileName << " with " << Cache.size()
+              << " positions" << sync_endl;
+}
+
+Depth probe(const Position&    pos,
+            const OptionsMap&  options,
+            Search::RootMoves& rootMoves,
+            Depth              depth) {
+
+    std::lock_guard<std::mutex> lk(Mutex);
+
+    if (!Capacity || near_draw(pos))
+        return 0;
+
+    auto it = Cache.find(key(pos, options));
+
+    if (it == Cache.end() || it->second.depth <= depth)
+        return 0;
+
+    Entry& e = it->second;
+
+    // A key collision is caught when a stored move is not legal here
+    for (const StoredMove& sm : e.moves)
+        if (sm.pv.empty()
+            || std::find(rootMoves.begin(), rootMoves.end(), sm.pv[0]) == rootMoves.end())
+            return 0;
+
+    e.lastUsed = ++Tick;
+
+    auto front = rootMoves.begin();
+
+    for (const StoredMove& sm : e.moves)
+    {
+        auto rm = std::find(front, rootMoves.end(), sm.pv[0]);
+        std::rotate(front, rm, rm + 1);
+
+        front->score = front->previousScore = front->uciScore = sm.score;
+        front->averageScore                                     = sm.averageScore;
+        front->selDepth                                         = sm.selDepth;
+        front->pv                                               = sm.pv;
+        ++front;
+    }
+
+    return e.depth;
+}
+
+void store(const Position&          pos,
+           const OptionsMap&        options,
+           Depth                    depth,
+           const Search::RootMoves& rootMoves) {
+
+    std::lock_guard<std::mutex> lk(Mutex);
+
+    if (!Capacity || depth < MinDepth || near_draw(pos))
+        return;
+
+    const Key    k       = key(pos, options);
+    const size_t multiPV = std::min({size_t(int(options["MultiPV"])), rootMoves.size(), size_t(255)});
+    auto         it      = Cache.find(k);
+
+    if (it != Cache.end() && it->second.depth >= depth)
+        return;
+
+    Entry e{depth, ++Tick, {}};
+
+    for (size_t i = 0; i < multiPV && rootMoves[i].score != -VALUE_INFINITE; ++i)
+        e.moves.push_back({rootMoves[i].score, rootMoves[i].averageScore, rootMoves[i].selDepth,
+                           rootMoves[i].pv});
+
+    if (e.moves.empty())
+        return;
+
+    {
+        std::ofstream out(FileName, std::ios::binary | std::ios::app);
+
+        if (out.tellp() == 0)
+            write_header(out);
+
+        write_record(out, k, e);
+
+        if (!out)
+            sync_cout << "info string Failed to write " << FileName << sync_endl;
+        else
+            ++Records;
+    }
+
+    insert(k, e);
+
+    evict();
+    compact();
+}
+
+}  // namespace Brainlearn::Analysis
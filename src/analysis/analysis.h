@@ -0,0 +1,71 @@
+/*
+  Brainlearn, a UCI chess playing engine derived from Stockfish
+  Copyright (C) 2004-2024 Andrea Manzo, K.Kiniama and Brainlearn developers (see AUTHORS file)
+
+  Brainlearn is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Brainlearn is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ANALYSIS_H_INCLUDED
+#define ANALYSIS_H_INCLUDED
+
+#include <vector>
+
+#include "../types.h"
+
+namespace Brainlearn {
+class Position;
+class OptionsMap;
+
+namespace Search {
+struct RootMove;
+using RootMoves = std::vector<RootMove>;
+}
+}
+
+// A persistent cache of completed root searches, so that a position analysed
+// before is shown at once and its search goes on from the stored depth instead
+// of depth 1. Every entry holds the principal root moves of the deepest search
+// of a position, with their scores and PVs, keyed by the position key and the
+// settings the scores depend on (MultiPV, networks, strength).
+//
+// The file is an append-only log: a completed search appends one record, and
+// the last record of a key wins when loading. When the cache is full the least
+// recently used entries are evicted, and the file is rewritten once it holds
+// more superseded or evicted records than live ones. It is independent from
+// the experience file, which records the played moves for learning.
+namespace Brainlearn::Analysis {
+
+// Searches shallower than this are fast enough to be repeated
+constexpr Depth MinDepth = 10;
+
+// Called at startup and after every change to the "Analysis Cache" options
+void init(const OptionsMap& options);
+
+// If the position was searched deeper than 'depth', moves the stored root moves
+// to the front of rootMoves, with their scores and PVs, and returns the depth
+// they were searched to. Otherwise returns 0 and leaves rootMoves unchanged.
+Depth probe(const Position&    pos,
+            const OptionsMap&  options,
+            Search::RootMoves& rootMoves,
+            Depth              depth);
+
+// Records a completed search if it is deeper than the stored one
+void store(const Position&          pos,
+           const OptionsMap&        options,
+           Depth                    depth,
+           const Search::RootMoves& rootMoves);
+
+}  // namespace Brainlearn::Analysis
+
+#endif  // #ifndef ANALYSIS_H_INCLUDED
@@ -0,0 +1,1029 @@
+/*
+  Brainlearn, a UCI chess playing engine derived from Stockfish
+  Copyright (C) 2004-2024 Andrea Manzo, K.Kiniama and Brainlearn developers (see AUTHORS file)
+
+  Brainlearn is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Brainlearn is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "bitbase.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+#include "../bitboard.h"
+#include "../memory.h"
+#include "../misc.h"
+#include "../position.h"
+#include "../search.h"
+#include "../ucioption.h"
+#include "../book/file_mapping.h"
+
+using namespace Brainlearn;
+
+namespace Brainlearn::Bitbases {
+
+int MaxCardinality;
+
+}
+
+namespace {
+
+using namespace Brainlearn::Bitbases;
+
+constexpr uint32_t BitbaseMagic   = 0x42424B4D;  // "MKBB"
+constexpr uint32_t BitbaseVersion = 2;
+constexpr char     BitbaseSuffix[] = ".mkb";
+
+// Distance to mate codes used during generation. A resolved position stores its
+// distance to mate in plies plus one: odd distances are wins for the side to
+// move, even ones are losses.
+constexpr uint8_t UNKNOWN = 0;
+constexpr uint8_t MAX_DTM = 253;
+constexpr uint8_t DRAWN   = 254;
+constexpr uint8_t INVALID = 255;
+
+// Special values of the per-position counter of unresolved quiet successors
+constexpr uint8_t NEVER_LOST = 255;
+
+struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t entries;
+    uint8_t  pieceCount;
+    uint8_t  pieces[7];
+    uint8_t  padding[8];
+};
+
+static_assert(sizeof(Header) == 32, "Unexpected bitbase header size");
+
+// Three results (WDLScore + 2, that is 0..4) are packed in a byte as base 5 digits
+uint8_t Unpacked[256][3];
+
+int side_value(const std::vector<PieceType>& side) {
+    int v = 0;
+    for (PieceType pt : side)
+        v += PieceValue[pt];
+    return v;
+}
+
+std::string side_string(std::vector<PieceType> side) {
+    std::sort(side.begin(), side.end(), std::greater<PieceType>());
+    std::string s = "K";
+    for (PieceType pt : side)
+        s += PieceToChar[pt];
+    return s;
+}
+
+// The stronger side is stored as white, so only one orientation of every
+// material signature has to be generated.
+bool is_canonical(const std::vector<PieceType>& w, const std::vector<PieceType>& b) {
+    int vw = side_value(w), vb = side_value(b);
+    return vw != vb ? vw > vb : side_string(w) >= side_string(b);
+}
+
+// Material code of a set of pieces, four bits for every non-king piece
+uint64_t material_code(const Piece* pc, int n) {
+    uint64_t code = 0;
+    for (int i = 0; i < n; ++i)
+        if (type_of(pc[i]) != KING)
+            code += uint64_t(1) << (4 * (8 * color_of(pc[i]) + type_of(pc[i])));
+    return code;
+}
+
+uint64_t material_code(const Position& pos) {
+    uint64_t code = 0;
+    for (Color c : {WHITE, BLACK})
+        for (PieceType pt = PAWN; pt < KING; ++pt)
+            code += uint64_t(popcount(pos.pieces(c, pt))) << (4 * (8 * c + pt));
+    return code;
+}
+
+// Slot order inside a table: white king, black king, then the other pieces of
+// each side by decreasing piece type.
+int slot_order(Piece pc) {
+    return type_of(pc) == KING ? int(color_of(pc)) : 2 + 8 * color_of(pc) + (KING - type_of(pc));
+}
+
+void sort_slots(Piece* pc, Square* sq, int n) {
+    for (int i = 1; i < n; ++i)
+        for (int j = i; j > 0 && slot_order(pc[j]) < slot_order(pc[j - 1]); --j)
+            std::swap(pc[j], pc[j - 1]), std::swap(sq[j], sq[j - 1]);
+}
+
+// Parses a signature like "KRSvKP" into the canonical piece list of its table,
+// flipping colors when the stronger side is the black one.
+bool parse_signature(const std::string& sig, std::vector<Piece>& pieces) {
+
+    size_t v = sig.find('v');
+    if (v == std::string::npos)
+        return false;
+
+    std::vector<PieceType> sides[COLOR_NB];
+    std::string            names[COLOR_NB] = {sig.substr(0, v), sig.substr(v + 1)};
+
+    for (Color c : {WHITE, BLACK})
+    {
+        if (names[c].empty() || names[c][0] != 'K')
+            return false;
+
+        for (size_t i = 1; i < names[c].size(); ++i)
+        {
+            size_t idx = PieceToChar.find(char(toupper(names[c][i])));
+            if (idx == std::string_view::npos || idx == 0 || idx == KING)
+                return false;
+            sides[c].push_back(PieceType(idx));
+        }
+    }
+
+    if (!is_canonical(sides[WHITE], sides[BLACK]))
+        std::swap(sides[WHITE], sides[BLACK]);
+
+    pieces = {W_KING, B_KING};
+    for (Color c : {WHITE, BLACK})
+        for (PieceType pt : sides[c])
+            pieces.push_back(make_piece(c, pt));
+
+    std::vector<Square> unused(pieces.size());
+    sort_slots(pieces.data(), unused.data(), int(pieces.size()));
+
+    return pieces.size() >= 3 && int(pieces.size()) <= MaxPieces;
+}
+
+std::string signature(const std::vector<Piece>& pieces) {
+    std::vector<PieceType> sides[COLOR_NB];
+    for (Piece pc : pieces)
+        if (type_of(pc) != KING)
+            sides[color_of(pc)].push_back(type_of(pc));
+
+    return side_string(sides[WHITE]) + "v" + side_string(sides[BLACK]);
+}
+
+// All canonical signatures with at most 'maxPieces' pieces, smallest first
+std::vector<std::string> all_signatures(int maxPieces) {
+
+    std::vector<std::vector<PieceType>> multisets = {{}};
+    constexpr PieceType                 Types[]   = {QUEEN, ROOK, BISHOP, KNIGHT, PAWN};
+
+    for (int size = 1; size <= maxPieces - 2; ++size)
+        for (size_t i = 0, end = multisets.size(); i < end; ++i)
+            if (int(multisets[i].size()) == size - 1)
+                for (PieceType pt : Types)
+                    if (multisets[i].empty() || pt <= multisets[i].back())
+                    {
+                        auto m = multisets[i];
+                        m.push_back(pt);
+                        multisets.push_back(m);
+                    }
+
+    std::vector<std::string> sigs;
+    for (int n = 3; n <= maxPieces; ++n)
+        for (const auto& w : multisets)
+            for (const auto& b : multisets)
+                if (int(w.size() + b.size()) == n - 2 && is_canonical(w, b))
+                    sigs.push_back(side_string(w) + "v" + side_string(b));
+
+    return sigs;
+}
+
+// Maps a position of a table to its index. The white king is kept on the
+// queen side (files A to D) by mirroring the board, since all the Makruk
+// pieces move symmetrically with respect to the vertical axis.
+struct Layout {
+    std::vector<Piece> pieces;
+
+    int      size() const { return int(pieces.size()); }
+    uint64_t entries() const { return uint64_t(2 * 32) << (6 * (pieces.size() - 1)); }
+
+    uint64_t index(Color stm, const Square* sq) const {
+
+        const int mirror = file_of(sq[0]) > FILE_D ? int(SQ_H1) : 0;
+        Square    ksq    = Square(int(sq[0]) ^ mirror);
+        uint64_t  idx    = stm * 32 + rank_of(ksq) * 4 + file_of(ksq);
+
+        for (int i = 1; i < size(); ++i)
+            idx = (idx << 6) | uint64_t(int(sq[i]) ^ mirror);
+
+        return idx;
+    }
+
+    void decode(uint64_t idx, Color& stm, Square* sq) const {
+
+        for (int i = size() - 1; i > 0; --i, idx >>= 6)
+            sq[i] = Square(idx & 63);
+
+        sq[0] = make_square(File(idx % 4), Rank((idx % 32) / 4));
+        stm   = Color(idx / 32);
+    }
+};
+
+// Returns true if square 's' is attacked by the pieces of color 'by'. The
+// piece in slot 'skip', if any, has just been captured.
+bool attacked(
+  const Piece* pc, const Square* sq, int n, Square s, Color by, Bitboard occupied, int skip = -1) {
+
+    for (int i = 0; i < n; ++i)
+    {
+        if (i == skip || color_of(pc[i]) != by)
+            continue;
+
+        PieceType pt = type_of(pc[i]);
+        if ((pt == PAWN ? pawn_attacks_bb(by, sq[i]) : attacks_bb(pt, sq[i], occupied)) & s)
+            return true;
+    }
+
+    return false;
+}
+
+bool valid_pawn_square(Color c, Square s) {
+    Rank r = relative_rank(c, s);
+    return r >= RANK_3 && r <= RANK_5;
+}
+
+// Maximum number of moves the winning side has to give mate once the counting
+// starts in a position with the given material. Pieces' honor counting applies
+// when the losing side has a bare king, board's honor counting when there are
+// no more pawns on the board.
+int counting_limit(const Piece* pc, int n, Color winner) {
+
+    int count[COLOR_NB][PIECE_TYPE_NB] = {};
+    for (int i = 0; i < n; ++i)
+        count[color_of(pc[i])][type_of(pc[i])]++;
+
+    if (count[WHITE][PAWN] || count[BLACK][PAWN])
+        return INT32_MAX;
+
+    bool bareKing = true;
+    for (PieceType pt = PAWN; pt < KING; ++pt)
+        bareKing &= !count[~winner][pt];
+
+    // The count starts from the number of pieces on the board plus one
+    if (bareKing)
+        return std::max(pieces_honor_limit(count[winner]) - n, 0);
+
+    return 64;
+}
+
+template<typename F>
+void parallel_for(uint64_t size, int threadCount, F&& f) {
+
+    constexpr uint64_t       Chunk = 1 << 14;
+    std::atomic<uint64_t>    next{0};
+    std::vector<std::thread> workers;
+
+    for (int t = 0; t < threadCount; ++t)
+        workers.emplace_back([&]() {
+            for (uint64_t begin; (begin = next.fetch_add(Chunk)) < size;)
+                for (uint64_t i = begin, end = std::min(size, begin + Chunk); i < end; ++i)
+                    f(i);
+        });
+
+    for (std::thread& th : workers)
+        th.join();
+}
+
+
+// Retrograde generator. Every table keeps the distance to mate of all its
+// positions in memory, because it is needed to resolve the conversions (captures
+// and promotions) of the bigger tables and to classify the wins under the
+// counting rules. Only the final WDL results are written to disk.
+class Generator {
+   public:
+    Generator(const std::string& p, int t) :
+        path(p),
+        threadCount(std::max(1, t)) {
+        for (PieceType pt = KNIGHT; pt <= KING; ++pt)
+            for (Square to = SQ_A1; to <= SQ_H8; ++to)
+                for (Square from = SQ_A1; from <= SQ_H8; ++from)
+                    if (attacks_bb(pt, from, 0) & to)
+                        origins[pt][to] |= from;
+    }
+
+    bool build(const std::string& sig);
+    void release(int minPieces);
+
+   private:
+    struct Table {
+        Layout                                  layout;
+        std::unique_ptr<std::atomic<uint8_t>[]> dtm;
+    };
+
+    // Child table of a conversion, in its stored orientation
+    struct Child {
+        const Table* table;
+        bool         flipped;
+    };
+
+    const Table* table(const std::vector<Piece>& pieces);
+    void         solve(Table& t);
+    bool         write(const Table& t) const;
+    uint8_t      probe_child(Piece* pc, Square* sq, int n, Color stm) const;
+
+    std::string                                   path;
+    int                                           threadCount;
+    std::map<std::string, std::unique_ptr<Table>> tables;
+    std::unordered_map<uint64_t, Child>           children;
+    Bitboard                                      origins[PIECE_TYPE_NB][SQUARE_NB] = {};
+};
+
+bool Generator::build(const std::string& sig) {
+
+    std::vector<Piece> pieces;
+    if (!parse_signature(sig, pieces))
+    {
+        sync_cout << "info string Invalid bitbase signature: " << sig << sync_endl;
+        return false;
+    }
+
+    return table(pieces) != nullptr;
+}
+
+// Frees the tables with at least 'minPieces' pieces. Tables with fewer pieces are
+// kept, since they are the conversion targets of many bigger tables.
+void Generator::release(int minPieces) {
+    for (auto it = tables.begin(); it != tables.end();)
+        it = it->second->layout.size() >= minPieces ? tables.erase(it) : std::next(it);
+}
+
+const Generator::Table* Generator::table(const std::vector<Piece>& pieces) {
+
+    std::string sig = signature(pieces);
+    auto        it  = tables.find(sig);
+
+    if (it != tables.end())
+        return it->second.get();
+
+    // Generate first all the tables reachable with a capture, a promotion or a
+    // capturing promotion.
+    std::vector<std::vector<Piece>> conversions;
+    for (size_t j = 0; j <= pieces.size(); ++j)
+    {
+        auto promoted = pieces;
+
+        if (j < pieces.size())
+        {
+            if (type_of(pieces[j]) != PAWN)
+                continue;
+
+            promoted[j] = make_piece(color_of(pieces[j]), QUEEN);
+            conversions.push_back(promoted);
+        }
+
+        for (size_t i = 0; i < pieces.size(); ++i)
+            if (type_of(pieces[i]) != KING
+                && (j == pieces.size() || color_of(pieces[i]) != color_of(pieces[j])))
+            {
+                auto captured = promoted;
+                captured.erase(captured.begin() + i);
+                conversions.push_back(captured);
+            }
+    }
+
+    for (auto& conv : conversions)
+    {
+        if (conv.size() <= 2)
+            continue;
+
+        std::vector<Piece> canonical;
+        parse_signature(signature(conv), canonical);
+        if (!table(canonical))
+            return nullptr;
+    }
+
+    // Register the conversion targets with both color orientations
+    children.clear();
+    for (auto& conv : conversions)
+    {
+        if (conv.size() <= 2)
+            continue;
+
+        std::vector<Piece> canonical;
+        parse_signature(signature(conv), canonical);
+
+        const Table* child = tables[signature(canonical)].get();
+        children[material_code(canonical.data(), int(canonical.size()))] = {child, false};
+
+        for (Piece& pc : canonical)
+            pc = ~pc;
+
+        children.emplace(material_code(canonical.data(), int(canonical.size())),
+                         Child{child, true});
+    }
+
+    auto t    = std::make_unique<Table>();
+    t->layout = {pieces};
+
+    TimePoint start = now();
+    sync_cout << "info string Generating bitbase " << sig << sync_endl;
+
+    t->dtm = std::make_unique<std::atomic<uint8_t>[]>(t->layout.entries());
+    solve(*t);
+
+    if (!write(*t))
+        return nullptr;
+
+    sync_cout << "info string Bitbase " << sig << " done in " << (now() - start) / 1000 << "s"
+              << sync_endl;
+
+    return (tables[sig] = std::move(t)).get();
+}
+
+// Probes the distance to mate of a conversion target. Piece and square arrays
+// are given in any order and are modified.
+uint8_t Generator::probe_child(Piece* pc, Square* sq, int n, Color stm) const {
+
+    if (n <= 2)
+        return DRAWN;
+
+    auto it = children.find(material_code(pc, n));
+    assert(it != children.end());
+
+    if (it->second.flipped)
+    {
+        for (int i = 0; i < n; ++i)
+            pc[i] = ~pc[i], sq[i] = flip_rank(sq[i]);
+        stm = ~stm;
+    }
+
+    sort_slots(pc, sq, n);
+
+    const Table& t = *it->second.table;
+    return t.dtm[t.layout.index(stm, sq)].load(std::memory_order_relaxed);
+}
+
+// Iterative retrograde analysis. The first pass sets up every position: it
+// marks the illegal ones, finds mates and stalemates, resolves the conversions
+// against the smaller tables and counts the quiet successors. Then, ply after
+// ply, the positions resolved at the previous ply are un-moved to reach their
+// predecessors: a predecessor of a loss is a win, and a predecessor is lost
+// once all its successors are known to be wins.
+void Generator::solve(Table& t) {
+
+    const Layout&  layout  = t.layout;
+    const int      n       = layout.size();
+    const Piece*   pc      = layout.pieces.data();
+    const uint64_t entries = layout.entries();
+
+    auto count   = std::make_unique<std::atomic<uint8_t>[]>(entries);
+    auto pending = std::make_unique<uint8_t[]>(entries);
+
+    std::atomic<int> maxPending{0};
+
+    parallel_for(entries, threadCount, [&](uint64_t idx) {
+        Color    stm;
+        Square   sq[MaxPieces];
+        Bitboard byColor[COLOR_NB] = {};
+
+        layout.decode(idx, stm, sq);
+        count[idx].store(NEVER_LOST, std::memory_order_relaxed);
+        pending[idx] = 0;
+
+        for (int i = 0; i < n; ++i)
+        {
+            if ((byColor[WHITE] | byColor[BLACK]) & sq[i])
+            {
+                t.dtm[idx].store(INVALID, std::memory_order_relaxed);
+                return;
+            }
+            byColor[color_of(pc[i])] |= sq[i];
+        }
+
+        const Bitboard occupied = byColor[WHITE] | byColor[BLACK];
+
+        for (int i = 2; i < n; ++i)
+            if (type_of(pc[i]) == PAWN && !valid_pawn_square(color_of(pc[i]), sq[i]))
+            {
+                t.dtm[idx].store(INVALID, std::memory_order_relaxed);
+                return;
+            }
+
+        // The side not to move cannot be in check
+        if (attacked(pc, sq, n, sq[~stm], stm, occupied))
+        {
+            t.dtm[idx].store(INVALID, std::memory_order_relaxed);
+            return;
+        }
+
+        int  quiet = 0, legal = 0, bestWin = 0, worstLoss = 0;
+        bool drawExit = false;
+
+        for (int i = 0; i < n; ++i)
+        {
+            if (color_of(pc[i]) != stm)
+                continue;
+
+            const PieceType pt   = type_of(pc[i]);
+            const Square    from = sq[i];
+            Bitboard        b =
+              pt == PAWN ? (pawn_attacks_bb(stm, from) & byColor[~stm])
+                             | (square_bb(from + pawn_push(stm)) & ~occupied)
+                                : attacks_bb(pt, from, occupied) & ~byColor[stm];
+
+            while (b)
+            {
+                const Square to = pop_lsb(b);
+
+                int captured = -1;
+                for (int j = 0; j < n; ++j)
+                    if (j != i && sq[j] == to)
+                        captured = j;
+
+                Square after[MaxPieces];
+                std::copy(sq, sq + n, after);
+                after[i] = to;
+
+                if (attacked(pc, after, n, after[stm], ~stm, (occupied ^ from) | to, captured))
+                    continue;
+
+                ++legal;
+
+                const bool promotion = pt == PAWN && relative_rank(stm, to) == RANK_6;
+
+                if (captured < 0 && !promotion)
+                {
+                    ++quiet;
+                    continue;
+                }
+
+                Piece  cpc[MaxPieces];
+                Square csq[MaxPieces];
+                int    cn = 0;
+
+                for (int j = 0; j < n; ++j)
+                    if (j != captured)
+                    {
+                        cpc[cn]   = j == i && promotion ? make_piece(stm, QUEEN) : pc[j];
+                        csq[cn++] = after[j];
+                    }
+
+                const uint8_t v = probe_child(cpc, csq, cn, ~stm);
+
+                if (v == DRAWN || v == UNKNOWN)
+                    drawExit = true;
+
+                // A lost successor makes this position a win, a won one is a
+                // candidate for the distance of a loss.
+                else if ((v - 1) % 2 == 0)
+                    bestWin = bestWin ? std::min(bestWin, v + 1) : v + 1;
+                else
+                    worstLoss = std::max(worstLoss, v + 1);
+            }
+        }
+
+        if (!legal)
+        {
+            bool inCheck = attacked(pc, sq, n, sq[stm], ~stm, occupied);
+            t.dtm[idx].store(inCheck ? 1 : DRAWN, std::memory_order_relaxed);
+            return;
+        }
+
+        t.dtm[idx].store(UNKNOWN, std::memory_order_relaxed);
+
+        // Distances beyond the horizon are draws under any counting rule
+        if (bestWin && bestWin <= MAX_DTM)
+            pending[idx] = uint8_t(bestWin);
+
+        else if (!drawExit && !bestWin && worstLoss <= MAX_DTM)
+        {
+            count[idx].store(uint8_t(quiet), std::memory_order_relaxed);
+            pending[idx] = uint8_t(worstLoss);
+        }
+
+        if (pending[idx])
+        {
+            int m = maxPending.load(std::memory_order_relaxed);
+            while (m < pending[idx] && !maxPending.compare_exchange_weak(m, pending[idx]))
+            {}
+        }
+    });
+
+    auto resolve = [&](uint64_t idx, uint8_t v) {
+        uint8_t expected = UNKNOWN;
+        return t.dtm[idx].compare_exchange_strong(expected, v, std::memory_order_relaxed);
+    };
+
+    // Positions resolved at ply 'ply' store ply + 1, so the frontier holds the
+    // value 'ply + 1' and the newly resolved positions get 'ply + 2'.
+    for (int ply = 0; ply + 2 <= MAX_DTM; ++ply)
+    {
+        const uint8_t     frontier = uint8_t(ply + 1), next = uint8_t(ply + 2);
+        std::atomic<bool> changed{false};
+
+        parallel_for(entries, threadCount, [&](uint64_t idx) {
+            const uint8_t v = t.dtm[idx].load(std::memory_order_relaxed);
+
+            if (v == UNKNOWN)
+            {
+                const uint8_t c = count[idx].load(std::memory_order_relaxed);
+                if ((c == NEVER_LOST || c == 0) && pending[idx] == next && resolve(idx, next))
+                    changed.store(true, std::memory_order_relaxed);
+                return;
+            }
+
+            if (v != frontier)
+                return;
+
+            Color  stm;
+            Square sq[MaxPieces];
+            layout.decode(idx, stm, sq);
+
+            const Color moved    = ~stm;
+            Bitboard    occupied = 0;
+            for (int i = 0; i < n; ++i)
+                occupied |= sq[i];
+
+            for (int j = 0; j < n; ++j)
+            {
+                if (color_of(pc[j]) != moved)
+                    continue;
+
+                const PieceType pt = type_of(pc[j]);
+                const Square    to = sq[j];
+                Bitboard        b  = pt == PAWN ? square_bb(to - pawn_push(moved))
+                                   : pt == ROOK ? attacks_bb<ROOK>(to, occupied)
+                                                : origins[pt][to];
+                b &= ~occupied;
+
+                while (b)
+                {
+                    Square before[MaxPieces];
+                    std::copy(sq, sq + n, before);
+                    before[j] = pop_lsb(b);
+
+                    const uint64_t prev = layout.index(moved, before);
+
+                    if (t.dtm[prev].load(std::memory_order_relaxed) != UNKNOWN)
+                        continue;
+
+                    // The predecessor can move into a lost position: it is a win
+                    if (ply % 2 == 0)
+                    {
+                        if (resolve(prev, next))
+                            changed.store(true, std::memory_order_relaxed);
+                        continue;
+                    }
+
+                    // Otherwise one more of its quiet successors is a win
+                    uint8_t c = count[prev].load(std::memory_order_relaxed);
+                    if (c == NEVER_LOST)
+                        continue;
+
+                    c = count[prev].fetch_sub(1, std::memory_order_relaxed) - 1;
+                    if (c == 0 && pending[prev] <= next && resolve(prev, next))
+                        changed.store(true, std::memory_order_relaxed);
+                }
+            }
+        });
+
+        if (!changed && next >= maxPending)
+            break;
+    }
+
+    // Whatever is still unresolved can be held forever
+    parallel_for(entries, threadCount, [&](uint64_t idx) {
+        if (t.dtm[idx].load(std::memory_order_relaxed) == UNKNOWN)
+            t.dtm[idx].store(DRAWN, std::memory_order_relaxed);
+    });
+}
+
+// Converts the distances to mate into WDL results under the counting rules,
+// assuming the count starts in the stored position, and writes the packed file.
+bool Generator::write(const Table& t) const {
+
+    const Layout&  layout  = t.layout;
+    const int      n       = layout.size();
+    const uint64_t entries = layout.entries();
+    const uint64_t bytes   = (entries + 2) / 3;
+
+    const int limit[COLOR_NB] = {counting_limit(layout.pieces.data(), n, WHITE),
+                                 counting_limit(layout.pieces.data(), n, BLACK)};
+
+    std::vector<uint8_t>  data(bytes);
+    std::atomic<uint64_t> results[5] = {};
+
+    parallel_for(bytes, threadCount, [&](uint64_t b) {
+        uint8_t packed = 0;
+        for (int k = 2; k >= 0; --k)
+        {
+            const uint64_t idx = 3 * b + k;
+            const uint8_t  v   = idx < entries ? t.dtm[idx].load(std::memory_order_relaxed) : DRAWN;
+            int            wdl = WDLDraw;
+
+            if (v != DRAWN && v != INVALID && v != UNKNOWN)
+            {
+                const int   dtm    = v - 1;
+                const bool  win    = dtm % 2;
+                const Color stm    = Color(idx / (entries / 2));
+                const Color winner = win ? stm : ~stm;
+                const int   moves  = (dtm + 1) / 2;
+
+                wdl = moves <= limit[winner] ? (win ? WDLWin : WDLLoss)
+                                             : (win ? WDLCursedWin : WDLBlessedLoss);
+            }
+
+            if (idx < entries && v != INVALID)
+                results[wdl + 2].fetch_add(1, std::memory_order_relaxed);
+
+            packed = uint8_t(packed * 5 + wdl + 2);
+        }
+        data[b] = packed;
+    });
+
+    Header header{};
+    header.magic      = BitbaseMagic;
+    header.version    = BitbaseVersion;
+    header.entries    = entries;
+    header.pieceCount = uint8_t(n);
+    for (int i = 0; i < n; ++i)
+        header.pieces[i] = uint8_t(layout.pieces[i]);
+
+    const std::string fileName =
+      Util::combine_path(path, signature(layout.pieces) + BitbaseSuffix);
+    std::ofstream out(fileName, std::ios::binary | std::ios::trunc);
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(data.data()), std::streamsize(data.size()));
+
+    if (!out)
+    {
+        sync_cout << "info string Failed to write bitbase " << fileName << sync_endl;
+        return false;
+    }
+
+    sync_cout << "info string " << fileName << ": win " << results[4] << " cursed win "
+              << results[3] << " draw " << results[2] << " blessed loss " << results[1]
+              << " loss " << results[0] << sync_endl;
+
+    return true;
+}
+
+
+// A mapped bitbase file
+struct BitbaseTable {
+    FileMapping    mapping;
+    Layout         layout;
+    const uint8_t* data;
+};
+
+std::vector<std::unique_ptr<BitbaseTable>> Tables;
+
+// Material code to table, the flag is set if the position must be color flipped
+std::unordered_map<uint64_t, std::pair<const BitbaseTable*, bool>> TableByCode;
+
+bool load(const std::string& fileName) {
+
+    auto t = std::make_unique<BitbaseTable>();
+
+    if (!t->mapping.map(fileName, false, Memory::BITBASES))
+        return false;
+
+    const Header* header = reinterpret_cast<const Header*>(t->mapping.data());
+
+    if (t->mapping.data_size() < sizeof(Header) || header->magic != BitbaseMagic
+        || header->version != BitbaseVersion || header->pieceCount < 3
+        || header->pieceCount > MaxPieces)
+    {
+        sync_cout << "info string Corrupted bitbase file " << fileName << sync_endl;
+        return false;
+    }
+
+    for (int i = 0; i < header->pieceCount; ++i)
+        t->layout.pieces.push_back(Piece(header->pieces[i]));
+
+    if (header->entries != t->layout.entries()
+        || t->mapping.data_size() < sizeof(Header) + (header->entries + 2) / 3)
+    {
+        sync_cout << "info string Corrupted bitbase file " << fileName << sync_endl;
+        return false;
+    }
+
+    t->data = t->mapping.data() + sizeof(Header);
+
+    std::vector<Piece> flipped;
+    for (Piece pc : t->layout.pieces)
+        flipped.push_back(~pc);
+
+    const int n = t->layout.size();
+    TableByCode[material_code(t->layout.pieces.data(), n)] = {t.get(), false};
+    TableByCode.emplace(material_code(flipped.data(), n), std::make_pair(t.get(), true));
+
+    MaxCardinality = std::max(MaxCardinality, n);
+    Tables.push_back(std::move(t));
+    return true;
+}
+
+}  // namespace
+
+
+namespace Brainlearn::Bitbases {
+
+// Called at startup and after every change to the "BitbasePath" UCI option to
+// (re)map the bitbase files. The path may contain several directories separated
+// by ':' on Unix-like systems and by ';' on Windows.
+void init(const std::string& paths) {
+
+    for (int i = 0; i < 256; ++i)
+        Unpacked[i][0] = i / 25, Unpacked[i][1] = (i / 5) % 5, Unpacked[i][2] = i % 5;
+
+    TableByCode.clear();
+    Tables.clear();
+    MaxCardinality = 0;
+
+    if (paths.empty() || paths == "<empty>")
+        return;
+
+#if defined(_WIN32)
+    constexpr char SepChar = ';';
+#else
+    constexpr char SepChar = ':';
+#endif
+
+    const auto sigs = all_signatures(MaxPieces);
+
+    std::stringstream ss(paths);
+    std::string       dir;
+
+    while (std::getline(ss, dir, SepChar))
+        for (const auto& sig : sigs)
+        {
+            std::vector<Piece> pieces;
+            parse_signature(sig, pieces);
+
+            // The first directory in the path has precedence
+            if (!TableByCode.count(material_code(pieces.data(), int(pieces.size()))))
+                load(Util::combine_path(dir, sig + BitbaseSuffix));
+        }
+
+    sync_cout << "info string Found " << Tables.size() << " bitbases" << sync_endl;
+}
+
+// Probes the WDL result of the position from the point of view of the side to
+// move. The counting is assumed to start in the probed position.
+WDLScore probe_wdl(const Position& pos, ProbeState* result) {
+
+    *result = FAIL;
+
+    const int n = pos.count<ALL_PIECES>();
+
+    if (n == 2)
+    {
+        *result = OK;
+        return WDLDraw;
+    }
+
+    if (n > MaxCardinality)
+        return WDLDraw;
+
+    auto it = TableByCode.find(material_code(pos));
+    if (it == TableByCode.end())
+        return WDLDraw;
+
+    const BitbaseTable& t       = *it->second.first;
+    const bool          flipped = it->second.second;
+
+    Square   sq[MaxPieces];
+    Piece    prev = NO_PIECE;
+    Bitboard b    = 0;
+
+    // Pieces of the same kind are consecutive in the table slots
+    for (int i = 0; i < n; ++i)
+    {
+        const Piece pc = flipped ? ~t.layout.pieces[i] : t.layout.pieces[i];
+
+        if (pc != prev)
+            b = pos.pieces(color_of(pc), type_of(pc)), prev = pc;
+
+        sq[i] = flipped ? flip_rank(pop_lsb(b)) : pop_lsb(b);
+    }
+
+    const Color    stm = flipped ? ~pos.side_to_move() : pos.side_to_move();
+    const uint64_t idx = t.layout.index(stm, sq);
+
+    *result = OK;
+    return WDLScore(Unpacked[t.data[idx / 3]][idx % 3] - 2);
+}
+
+// Ranks the root moves by their bitbase results. Since the bitbases store no
+// distance, the search is still needed to make progress inside a won ending.
+bool root_probe(Position& pos, Search::RootMoves& rootMoves, bool useCounting) {
+
+    static const int   WDL_to_rank[]  = {-1000, -899, 0, 899, 1000};
+    static const Value WDL_to_value[] = {-VALUE_MATE + MAX_PLY + 1, VALUE_DRAW - 2, VALUE_DRAW,
+                                         VALUE_DRAW + 2, VALUE_MATE - MAX_PLY - 1};
+
+    ProbeState result = OK;
+    StateInfo  st;
+
+    for (auto& m : rootMoves)
+    {
+        pos.do_move(m.pv[0], st);
+
+        WDLScore wdl = pos.is_draw(1) ? WDLDraw : WDLScore(-probe_wdl(pos, &result));
+
+        pos.undo_move(m.pv[0]);
+
+        if (result == FAIL)
+            return false;
+
+        m.tbRank = WDL_to_rank[wdl + 2];
+
+        if (!useCounting)
+            wdl = wdl > WDLDraw ? WDLWin : wdl < WDLDraw ? WDLLoss : WDLDraw;
+        m.tbScore = WDL_to_value[wdl + 2];
+    }
+
+    return true;
+}
+
+Config rank_root_moves(const OptionsMap& options, Position& pos, Search::RootMoves& rootMoves) {
+
+    Config config;
+
+    if (rootMoves.empty())
+        return config;
+
+    config.rootInTB    = false;
+    config.useCounting = bool(options["BitbaseCounting"]);
+    config.probeDepth  = int(options["BitbaseProbeDepth"]);
+    config.cardinality = int(options["BitbaseProbeLimit"]);
+
+    // Tables with fewer pieces than BitbaseProbeLimit are searched with
+    // probeDepth == DEPTH_ZERO
+    if (config.cardinality > MaxCardinality)
+    {
+        config.cardinality = MaxCardinality;
+        config.probeDepth  = 0;
+    }
+
+    if (config.cardinality >= pos.count<ALL_PIECES>())
+        config.rootInTB = root_probe(pos, rootMoves, config.useCounting);
+
+    if (config.rootInTB)
+    {
+        // Sort moves according to their bitbase rank
+        std::stable_sort(
+          rootMoves.begin(), rootMoves.end(),
+          [](const Search::RootMove& a, const Search::RootMove& b) { return a.tbRank > b.tbRank; });
+
+        // Probe during search only if we are winning
+        if (rootMoves[0].tbScore <= VALUE_DRAW)
+            config.cardinality = 0;
+    }
+    else
+    {
+        // Clean up if root_probe() failed
+        for (auto& m : rootMoves)
+            m.tbRank = 0;
+    }
+
+    return config;
+}
+
+bool generate(const std::string& path, const std::vector<std::string>& signatures, int threads) {
+
+    std::vector<std::string> sigs;
+    for (const auto& s : signatures)
+        if (!s.empty() && std::all_of(s.begin(), s.end(), ::isdigit))
+        {
+            const auto all = all_signatures(std::min(std::stoi(s), MaxPieces));
+            sigs.insert(sigs.end(), all.begin(), all.end());
+        }
+        else
+            sigs.push_back(s);
+
+    Generator gen(path, threads);
+
+    for (const auto& sig : sigs)
+    {
+        if (!gen.build(sig))
+            return false;
+
+        // Keep the memory bounded: the biggest tables are seldom conversion
+        // targets of the next ones.
+        gen.release(MaxPieces);
+    }
+
+    return true;
+}
+
+}  // namespace Brainlearn::Bitbases
@@ -0,0 +1,81 @@
+/*
+  Brainlearn, a UCI chess playing engine derived from Stockfish
+  Copyright (C) 2004-2024 Andrea Manzo, K.Kiniama and Brainlearn developers (see AUTHORS file)
+
+  Brainlearn is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Brainlearn is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef BITBASE_H_INCLUDED
+#define BITBASE_H_INCLUDED
+
+#include <string>
+#include <vector>
+
+#include "../types.h"
+
+namespace Brainlearn {
+class Position;
+class OptionsMap;
+
+namespace Search {
+struct RootMove;
+using RootMoves = std::vector<RootMove>;
+}
+}
+
+// Makruk endgame bitbases. Every file stores the game-theoretical result of all
+// positions of one material signature (3 to 5 pieces, kings included) from the
+// point of view of the side to move. The results take the Makruk counting rules
+// into account: a win that cannot be forced before the count expires, when the
+// count starts in the probed position, is stored as a cursed win.
+namespace Brainlearn::Bitbases {
+
+struct Config {
+    int   cardinality = 0;
+    bool  rootInTB    = false;
+    bool  useCounting = false;
+    Depth probeDepth  = 0;
+};
+
+enum WDLScore {
+    WDLLoss        = -2,  // Loss
+    WDLBlessedLoss = -1,  // Loss, but draw under the counting rules
+    WDLDraw        = 0,   // Draw
+    WDLCursedWin   = 1,   // Win, but draw under the counting rules
+    WDLWin         = 2,   // Win
+};
+
+// Possible states after a probing operation
+enum ProbeState {
+    FAIL = 0,  // Probe failed (missing file table)
+    OK   = 1   // Probe successful
+};
+
+constexpr int MaxPieces = 5;
+
+extern int MaxCardinality;
+
+void     init(const std::string& paths);
+WDLScore probe_wdl(const Position& pos, ProbeState* result);
+bool     root_probe(Position& pos, Search::RootMoves& rootMoves, bool useCounting);
+Config   rank_root_moves(const OptionsMap& options, Position& pos, Search::RootMoves& rootMoves);
+
+// Generates the bitbase files for the given material signatures ("KRvK",
+// "KSMvKP", ...) or for every signature up to the given number of pieces,
+// writing them into 'path'. Missing sub-tables are built along the way.
+bool generate(const std::string& path, const std::vector<std::string>& signatures, int threads);
+
+}  // namespace Brainlearn::Bitbases
+
+#endif  // #ifndef BITBASE_H_INCLUDED
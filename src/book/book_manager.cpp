@@ -73,19 +73,19 @@ Move BookManager::probe(const Position& pos, const OptionsMap& options) const {
 }
 
 void BookManager::show_moves(const Position& pos, const OptionsMap& options) const {
-    std::cout << pos << std::endl << std::endl;
+    sync_cout << pos << "\n" << sync_endl;
 
     for (size_t i = 0; i < NumberOfBooks; ++i)
     {
         if (books[i] == nullptr)
         {
-            std::cout << "Book " << i + 1 << ": No book loaded" << std::endl;
+            sync_cout << "Book " << i + 1 << ": No book loaded" << sync_endl;
         }
         else
         {
-            std::cout << "Book " << i + 1 << " (" << books[i]->type() << "): "
+            sync_cout << "Book " << i + 1 << " (" << books[i]->type() << "): "
                       << std::string(options[Util::format_string("CTG/BIN Book %d File", i + 1)])
-                      << std::endl;
+                      << sync_endl;
             books[i]->show_moves(pos);
         }
     }
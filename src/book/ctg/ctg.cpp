@@ -1058,8 +1058,7 @@ void CtgBook::show_moves(const Position& pos) const {
         }
     }
 
-    //Not using sync_cout/sync_endl
-    std::cout << ss.str() << std::endl;
+    sync_cout << ss.str() << sync_endl;
 }
 }
 }
\ No newline at end of file
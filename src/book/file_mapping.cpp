@@ -23,7 +23,7 @@ FileMapping::FileMapping() :
 
 FileMapping::~FileMapping() { unmap(); }
 
-bool FileMapping::map(const std::string& f, bool verbose) {
+bool FileMapping::map(const std::string& f, bool verbose, Memory::Subsystem subsystem) {
     unmap();
 
 #ifdef _WIN32
@@ -126,6 +126,7 @@ bool FileMapping::map(const std::string& f, bool verbose) {
     baseAddress = data;
     dataSize    = statbuf.st_size;
 #endif
+    Memory::track(subsystem, baseAddress, dataSize);
     return true;
 }
 
@@ -133,6 +134,8 @@ void FileMapping::unmap() {
     assert((mapping == 0) == (baseAddress == nullptr)
            && (baseAddress == nullptr) == (dataSize == 0));
 
+    Memory::untrack(baseAddress);
+
 #ifdef _WIN32
     if (baseAddress)
         UnmapViewOfFile(baseAddress);
@@ -4,6 +4,8 @@
 #include <cstddef>
 #include <string>
 
+#include "../memory.h"
+
 class FileMapping {
    private:
     uint64_t mapping;
@@ -14,7 +16,9 @@ class FileMapping {
     FileMapping();
     ~FileMapping();
 
-    bool map(const std::string& f, bool verbose);
+    bool map(const std::string&            f,
+             bool                          verbose,
+             Brainlearn::Memory::Subsystem subsystem = Brainlearn::Memory::BOOKS);
     void unmap();
 
     bool                 has_data() const;
@@ -378,7 +378,10 @@ std::string PolyglotBook::type() const { return "BIN"; }
 
 void PolyglotBook::close() {
     if (bookData)
+    {
+        Memory::untrack(bookData);
         free(bookData);
+    }
 
     bookData       = nullptr;
     bookDataLength = 0;
@@ -420,6 +423,8 @@ bool PolyglotBook::open(const std::string& f) {
     bookData       = (unsigned char*) inData;
     filename       = f;
 
+    Memory::track(Memory::BOOKS, bookData, bookDataLength);
+
     //Close the book file
     fm.unmap();
 
@@ -516,7 +521,7 @@ void PolyglotBook::show_moves(const Position& pos) const {
         }
     }
 
-    std::cout << ss.str() << std::endl;
+    sync_cout << ss.str() << sync_endl;
 }
 }
 }
\ No newline at end of file
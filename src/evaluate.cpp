@@ -46,9 +46,16 @@
 //     const unsigned char *const gEmbeddedNNUEEnd;     // a marker to the end
 //     const unsigned int         gEmbeddedNNUESize;    // the size of the embedded file
 // Note that this does not work in Microsoft Visual Studio.
+// With NNUE_EMBED_COMPRESSED the compressed networks written by
+// "make net netcompress=yes" are embedded instead (see nnue/nnue_compress.h).
 #if !defined(_MSC_VER) && !defined(NNUE_EMBEDDING_OFF)
+    #if defined(NNUE_EMBED_COMPRESSED)
+INCBIN(EmbeddedNNUEBig, EvalFileDefaultNameBig EvalFileCompressedExtension);
+INCBIN(EmbeddedNNUESmall, EvalFileDefaultNameSmall EvalFileCompressedExtension);
+    #else
 INCBIN(EmbeddedNNUEBig, EvalFileDefaultNameBig);
 INCBIN(EmbeddedNNUESmall, EvalFileDefaultNameSmall);
+    #endif
 #else
 const unsigned char        gEmbeddedNNUEBigData[1]   = {0x0};
 const unsigned char* const gEmbeddedNNUEBigEnd       = &gEmbeddedNNUEBigData[1];
@@ -107,25 +114,14 @@ NNUE::EvalFiles NNUE::load_networks(const std::string& rootDirectory,
 
                 if (directory == "<internal>" && user_eval_file == evalFile.defaultName)
                 {
-                    // C++ way to prepare a buffer for a memory stream
-                    class MemoryBuffer: public std::basic_streambuf<char> {
-                       public:
-                        MemoryBuffer(char* p, size_t n) {
-                            setg(p, p, p + n);
-                            setp(p, p + n);
-                        }
-                    };
-
-                    MemoryBuffer buffer(
-                      const_cast<char*>(reinterpret_cast<const char*>(
-                        netSize == Small ? gEmbeddedNNUESmallData : gEmbeddedNNUEBigData)),
-                      size_t(netSize == Small ? gEmbeddedNNUESmallSize : gEmbeddedNNUEBigSize));
+                    auto description = NNUE::load_eval(
+                      reinterpret_cast<const char*>(netSize == Small ? gEmbeddedNNUESmallData
+                                                                     : gEmbeddedNNUEBigData),
+                      size_t(netSize == Small ? gEmbeddedNNUESmallSize : gEmbeddedNNUEBigSize),
+                      netSize);
                     (void) gEmbeddedNNUEBigEnd;  // Silence warning on unused variable
                     (void) gEmbeddedNNUESmallEnd;
 
-                    std::istream stream(&buffer);
-                    auto         description = NNUE::load_eval(stream, netSize);
-
                     if (description.has_value())
                     {
                         evalFile.current        = user_eval_file;
@@ -186,6 +182,31 @@ int Eval::simple_eval(const Position& pos, Color c) {
 }
 
 
+namespace {
+
+// Blends the network output with optimism and material imbalance, and scales
+// it down with the material and the shuffling moves.
+Value blend(const Position& pos, int simpleEval, Value nnue, int nnueComplexity, int optimism) {
+
+    // Blend optimism and eval with nnue complexity and material imbalance
+    optimism += optimism * (nnueComplexity + std::abs(simpleEval - nnue)) / 512;
+    nnue -= nnue * (nnueComplexity + std::abs(simpleEval - nnue)) / 32768;
+
+    int npm = pos.non_pawn_material() / 64;
+    int v   = (nnue * (915 + npm + 9 * pos.count<PAWN>()) + optimism * (154 + npm)) / 1024;
+
+    // Damp down the evaluation linearly when shuffling
+    int shuffling = pos.rule50_count();
+    v             = v * (200 - shuffling) / 214;
+
+    // Guarantee evaluation does not hit the tablebase range
+    v = std::clamp(v, VALUE_TB_LOSS_IN_MAX_PLY + 1, VALUE_TB_WIN_IN_MAX_PLY - 1);
+
+    return v;
+}
+
+}  // namespace
+
 // Evaluate is the evaluator for the outer world. It returns a static evaluation
 // of the position from the point of view of the side to move.
 Value Eval::evaluate(const Position& pos, int optimism) {
@@ -200,21 +221,35 @@ Value Eval::evaluate(const Position& pos, int optimism) {
     Value nnue = smallNet ? NNUE::evaluate<NNUE::Small>(pos, true, &nnueComplexity)
                           : NNUE::evaluate<NNUE::Big>(pos, true, &nnueComplexity);
 
-    // Blend optimism and eval with nnue complexity and material imbalance
-    optimism += optimism * (nnueComplexity + std::abs(simpleEval - nnue)) / 512;
-    nnue -= nnue * (nnueComplexity + std::abs(simpleEval - nnue)) / 32768;
+    return blend(pos, simpleEval, nnue, nnueComplexity, optimism);
+}
 
-    int npm = pos.non_pawn_material() / 64;
-    int v   = (nnue * (915 + npm + 9 * pos.count<PAWN>()) + optimism * (154 + npm)) / 1024;
+// Cascaded evaluation: the positions that would go to the big net are first
+// evaluated with the small one, and that value is returned when it is clearly
+// outside the search window and the small net is confident about it. Otherwise
+// the big net is run as usual.
+Value Eval::evaluate(
+  const Position& pos, int optimism, Value alpha, Value beta, const Cascade& cascade) {
 
-    // Damp down the evaluation linearly when shuffling
-    int shuffling = pos.rule50_count();
-    v             = v * (200 - shuffling) / 214;
+    assert(!pos.checkers());
 
-    // Guarantee evaluation does not hit the tablebase range
-    v = std::clamp(v, VALUE_TB_LOSS_IN_MAX_PLY + 1, VALUE_TB_WIN_IN_MAX_PLY - 1);
+    int simpleEval = simple_eval(pos, pos.side_to_move());
 
-    return v;
+    if (!cascade.enabled || std::abs(simpleEval) > 1050)
+        return evaluate(pos, optimism);
+
+    int nnueComplexity;
+
+    Value nnue = NNUE::evaluate<NNUE::Small>(pos, true, &nnueComplexity);
+    Value v    = blend(pos, simpleEval, nnue, nnueComplexity, optimism);
+
+    if (nnueComplexity <= cascade.complexity
+        && (v < alpha - cascade.margin || v > beta + cascade.margin))
+        return v;
+
+    nnue = NNUE::evaluate<NNUE::Big>(pos, true, &nnueComplexity);
+
+    return blend(pos, simpleEval, nnue, nnueComplexity, optimism);
 }
 
 // Like evaluate(), but instead of returning a value, it returns
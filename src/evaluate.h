@@ -33,8 +33,17 @@ namespace Eval {
 
 std::string trace(Position& pos);
 
+// Settings of the cascaded evaluation, read from the UCI options when a
+// search starts
+struct Cascade {
+    bool enabled    = false;
+    int  margin     = 0;  // Distance to the window under which the big net is run
+    int  complexity = 0;  // Small net complexity over which the big net is run
+};
+
 int   simple_eval(const Position& pos, Color c);
 Value evaluate(const Position& pos, int optimism);
+Value evaluate(const Position& pos, int optimism, Value alpha, Value beta, const Cascade& cascade);
 
 // The default net name MUST follow the format nn-[SHA256 first 12 digits].nnue
 // for the build process (profile-build and fishtest) to work. Do not change the
@@ -42,6 +51,9 @@ Value evaluate(const Position& pos, int optimism);
 #define EvalFileDefaultNameBig "nn-b1a57edbea57.nnue"
 #define EvalFileDefaultNameSmall "nn-baff1ede1f90.nnue"
 
+// Networks saved under a name with this extension are compressed
+#define EvalFileCompressedExtension ".nnz"
+
 struct EvalFile {
     // UCI option name
     std::string optionName;
@@ -1,6 +1,7 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include "../memory.h"
 #include "../misc.h"
 #include "learn.h"
 
@@ -9,6 +10,9 @@ using namespace Brainlearn;
 LearningData LD;
 
 namespace {
+// A node of the hash table: the key, the pointer to the move and the link
+constexpr size_t HashNodeBytes = sizeof(Key) + 2 * sizeof(void*);
+
 LearningMode identify_learning_mode(const std::string& lm) {
     if (lm == "Off")
         return LearningMode::Off;
@@ -65,6 +69,7 @@ bool LearningData::load(const std::string& filename) {
 
     //Save pointer to fileData to be freed later
     mainDataBuffers.push_back(fileData);
+    Memory::track(Memory::LEARNING, fileData, fileSize);
 
     //Loop the moves from this file
     bool                   qLearning             = (learningMode == LearningMode::Self);
@@ -88,6 +93,7 @@ void LearningData::insert_or_update(PersistedLearningMove* plm, bool qLearning)
     {
         //Insert new key and learningMove
         HT.insert({plm->key, &plm->learningMove});
+        Memory::add(Memory::LEARNING, HashNodeBytes);
 
         //Flag for persisting
         needPersisting = true;
@@ -106,6 +112,7 @@ void LearningData::insert_or_update(PersistedLearningMove* plm, bool qLearning)
     if (itr == range.second)
     {
         HT.insert({plm->key, &plm->learningMove});
+        Memory::add(Memory::LEARNING, HashNodeBytes);
         bestNewMoveCandidate = &plm->learningMove;
 
         //Flag for persisting
@@ -184,7 +191,10 @@ void LearningData::clear() {
 
     //Release internal data buffers
     for (void* p : mainDataBuffers)
+    {
+        Memory::untrack(p);
         free(p);
+    }
 
     //Clear internal data buffers
     mainDataBuffers.clear();
@@ -195,6 +205,8 @@ void LearningData::clear() {
 
     //Clear internal new moves data buffers
     newMovesDataBuffers.clear();
+
+    Memory::set(Memory::LEARNING, 0);
 }
 
 void LearningData::init(Brainlearn::OptionsMap& o) {
@@ -336,6 +348,7 @@ void LearningData::add_new_learning(Key key, const LearningMove& lm) {
 
     //Save pointer to fileData to be freed later
     newMovesDataBuffers.push_back(newPlm);
+    Memory::add(Memory::LEARNING, sizeof(PersistedLearningMove));
 
     //Assign
     newPlm->key          = key;
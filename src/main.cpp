@@ -35,7 +35,6 @@ int main(int argc, char* argv[]) {
     UCI uci(argc, argv);   //Khalid
     LD.init(uci.options);  //Kelly
     Bitboards::init();
-    Position::init();
     Tune::init(uci.options);
 
     uci.evalFiles = Eval::NNUE::load_networks(uci.workingDirectory(), uci.options, uci.evalFiles);
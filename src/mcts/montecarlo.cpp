@@ -20,10 +20,13 @@
 #include <cassert>
 #include <cmath>
 #include <cstring>  // For std::memset, std::memcmp
+#include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <sstream>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 #include "../misc.h"
 #include "montecarlo.h"
@@ -34,7 +37,6 @@
 #include "../search.h"
 #include "../thread.h"
 #include "../uci.h"
-// #include "../syzygy/tbprobe.h"
 
 namespace Brainlearn {
 
@@ -57,6 +59,15 @@ inline bool comp_float(const double a, const double b, const double epsilon = 0.
     return fabs(a - b) < epsilon;
 }
 
+/// The result of an edge is the opposite of the result of the node it leads to
+inline Proof opposite(const Proof p) {
+    return p == PROOF_WIN ? PROOF_LOSS : p == PROOF_LOSS ? PROOF_WIN : p;
+}
+
+inline Reward proof_reward(const Proof p) {
+    return p == PROOF_WIN ? REWARD_MATE : p == PROOF_LOSS ? REWARD_MATED : REWARD_DRAW;
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////
 /// Comparison functions for edges
 ///////////////////////////////////////////////////////////////////////////////////////
@@ -133,6 +144,12 @@ mctsNodeInfo* get_node(const MonteCarlo* mcts, const Position& p) {
     Key           key2 = p.pawn_key();
     mctsNodeInfo* node = nullptr;
 
+    // While a Makruk count runs, the plies left before the draw are part of the
+    // node identity, so that a proven counting draw is not shared with the same
+    // position reached earlier in the count.
+    if (p.counting_limit())
+        key2 ^= Key(p.draw_horizon()) * 0x9E3779B97F4A7C15ULL;
+
     //Lock
     LOCK(mcts, createLock);
 
@@ -160,9 +177,11 @@ mctsNodeInfo* get_node(const MonteCarlo* mcts, const Position& p) {
     node->lastMove       = Move::none();  // the move between the parent and this node
     node->ttValue        = VALUE_NONE;
     node->AB             = false;
+    node->proof          = PROOF_NONE;
 
     //Insert into MCTS hash table
     MCTS.insert(make_pair(key1, node));
+    Memory::add(Memory::MCTS_TREE, MCTS_NODE_BYTES);
 
     return node;
 }
@@ -183,6 +202,7 @@ void MonteCarlo::add_prior_to_node(mctsNodeInfo* node, Move m, Reward prior) con
         node->children[n]->prior           = prior;
         node->children[n]->actionValue     = 0.0;
         node->children[n]->meanActionValue = 0.0;
+        node->children[n]->proof           = PROOF_NONE;
         node->number_of_sons++;
     }
     else
@@ -237,15 +257,30 @@ void MonteCarlo::search(Brainlearn::ThreadPool&        threads,
         if (ply >= 1)
             node->ttValue = backup(reward, AB_Rollout);
 
+        if (++playouts % 256 == 0)
+            publish_focus(threads);
+
         if (should_emit_pv(isMainThread))
-            emit_pv(worker, threads, tt);
+            emit_pv(worker, threads, tt, limits.silent);
     }
 
     if (ply >= 1)
         backup(reward, AB_Rollout);
 
-    if (should_emit_pv(isMainThread))
-        emit_pv(worker, threads, tt);
+    // A proven root ends the whole search, and its result is shown at once. As
+    // for the time limit, a ponder search stops at the ponderhit, and an infinite
+    // search goes on until the GUI stops it.
+    if (root->proof != PROOF_NONE && !threads.stop && !limits.infinite)
+    {
+        emit_pv(worker, threads, tt, limits.silent);
+
+        if (threads.main_manager()->ponder)
+            threads.main_manager()->stopOnPonderhit = true;
+        else
+            threads.stop = true;
+    }
+    else if (should_emit_pv(isMainThread))
+        emit_pv(worker, threads, tt, limits.silent);
 }
 
 /// MonteCarlo::MonteCarlo() is the constructor for the MonteCarlo class
@@ -301,6 +336,14 @@ bool MonteCarlo::computational_budget(Brainlearn::ThreadPool&        threads,
     if (limits.depth && maximumPly > limits.depth * 2)
         return false;
 
+    // Nothing is left to search once the result of the root is proven
+    if (root->proof != PROOF_NONE)
+        return false;
+
+    // The thread was moved back to alpha-beta
+    if (!threads.runs_mcts(thisThread->thread_idx))
+        return false;
+
     return !threads.stop.load(std::memory_order_relaxed);
 }
 
@@ -323,9 +366,14 @@ mctsNodeInfo* MonteCarlo::tree_policy(Brainlearn::ThreadPool&        threads,
         if (node->node_visits == 0)
             break;
 
-        if (!computational_budget(threads, limits) || is_terminal(node))
+        if (!computational_budget(threads, limits))
             return nullptr;
 
+        // A terminal node that could not be proven, a draw by repetition for
+        // instance, is scored again like a leaf.
+        if (is_terminal(node))
+            break;
+
         edges[ply] = best_child(node, STAT_UCB);
 
         const Move m = edges[ply]->move;
@@ -351,7 +399,8 @@ mctsNodeInfo* MonteCarlo::tree_policy(Brainlearn::ThreadPool&        threads,
         LOCK(this, node);
 
         const size_t greedy = TRand<size_t>(0, 100);
-        if (!is_root(node) && node->ttValue < VALUE_KNOWN_WIN && node->ttValue > -VALUE_KNOWN_WIN
+        if (!is_root(node) && !is_terminal(node) && node->ttValue < VALUE_KNOWN_WIN
+            && node->ttValue > -VALUE_KNOWN_WIN
             && (node->number_of_sons > 5 && greedy >= mctsMultiStrategy))
         {
             AB_Rollout = true;
@@ -370,7 +419,10 @@ Reward MonteCarlo::playout_policy(mctsNodeInfo* node) {
 
     // Step 0. Check for terminal nodes
     if (is_terminal(node))
+    {
+        prove_terminal(node);
         return evaluate_terminal(node);
+    }
 
     // Step 1. Expand the current node
     // We generate the legal moves and calculate their prior values.
@@ -382,7 +434,10 @@ Reward MonteCarlo::playout_policy(mctsNodeInfo* node) {
     }
 
     if (node->number_of_sons == 0)
+    {
+        prove_terminal(node);
         return evaluate_terminal(node);
+    }
 
     // Step 2. Return reward
     // Return the reward of the play-out from the point of view of the side to play.
@@ -421,6 +476,15 @@ Value MonteCarlo::backup(Reward r, bool AB_Mode) {
         edge->actionValue     = edge->actionValue + weight * r;
         edge->meanActionValue = edge->actionValue / edge->visits;
 
+        // A proven child proves the edge leading to it, whose mean is then
+        // the exact result, and maybe the node itself.
+        if (const Proof p = nodes[ply + 1]->proof; p != PROOF_NONE)
+        {
+            edge->proof           = opposite(p);
+            edge->meanActionValue = proof_reward(edge->proof);
+            update_proof(nodes[ply]);
+        }
+
         assert(edge->meanActionValue >= 0.0);
         assert(edge->meanActionValue <= 1.0);
 
@@ -452,6 +516,10 @@ Edge* MonteCarlo::best_child(mctsNodeInfo* node, EdgeStatistic statistic) const
     double bestValue = -1000000000000.0;
     for (int k = 0; k < node->number_of_sons; k++)
     {
+        // Proven moves need no more playouts
+        if (statistic == STAT_UCB && node->children[k]->proof != PROOF_NONE)
+            continue;
+
         const double r =
           statistic == STAT_VISITS ? node->children[k]->visits.load(std::memory_order_relaxed)
           : statistic == STAT_MEAN
@@ -469,9 +537,59 @@ Edge* MonteCarlo::best_child(mctsNodeInfo* node, EdgeStatistic statistic) const
         }
     }
 
+    // Every move is proven, which makes the node proven too: any of them will do
+    if (best == -1)
+        return best_child(node, STAT_MEAN);
+
     return node->children[best];
 }
 
+/// MonteCarlo::prove_terminal() stores the result of a terminal node when it
+/// does not depend on the path to the node: mates, stalemates, and draws by the
+/// Makruk counting rules, whose state is part of the node identity (see get_node).
+/// Draws by repetition are not proven.
+void MonteCarlo::prove_terminal(mctsNodeInfo* node) const {
+
+    LOCK(this, node);
+
+    if (node->node_visits > 0 && node->number_of_sons == 0)
+        node->proof = pos.checkers() ? PROOF_LOSS : PROOF_DRAW;
+
+    else if (pos.counting_limit() && pos.draw_horizon() <= 0 && pos.is_draw(ply - 1))
+        node->proof = PROOF_DRAW;
+}
+
+/// MonteCarlo::update_proof() applies the minimax rules of the MCTS-Solver to
+/// an expanded node: it is won as soon as one of its moves wins, and once all
+/// its moves are proven it is drawn if one of them draws, lost otherwise.
+void MonteCarlo::update_proof(mctsNodeInfo* node) const {
+
+    LOCK(this, node);
+
+    if (node->proof != PROOF_NONE || node->number_of_sons <= 0)
+        return;
+
+    bool draw = false;
+
+    for (int k = 0; k < node->number_of_sons; k++)
+    {
+        const Proof p = node->children[k]->proof;
+
+        if (p == PROOF_WIN)
+        {
+            node->proof = PROOF_WIN;
+            return;
+        }
+
+        if (p == PROOF_NONE)
+            return;
+
+        draw |= p == PROOF_DRAW;
+    }
+
+    node->proof = draw ? PROOF_DRAW : PROOF_LOSS;
+}
+
 /// MonteCarlo::should_emit_pv() checks if it should write the pv of the game tree.
 /// This function checks if the current thread is the 'main' thread. It also checks how
 /// much time has elapsed since the last time the principal variation has been printed
@@ -503,10 +621,12 @@ bool MonteCarlo::should_emit_pv(bool isMainThread) const {
 
 
 /// MonteCarlo::emit_pv() emits the principal variation (PV) of the game tree on the
-/// standard output stream, as requested by the UCI protocol.
+/// standard output stream, as requested by the UCI protocol. The root moves are
+/// updated even when the output is silenced.
 void MonteCarlo::emit_pv(Search::Worker*         worker,
                          Brainlearn::ThreadPool& threads,
-                         TranspositionTable&     tt) {
+                         TranspositionTable&     tt,
+                         bool                    silent) {
 
     assert(ply == 1);
 
@@ -523,6 +643,12 @@ void MonteCarlo::emit_pv(Search::Worker*         worker,
     else
         std::sort(list.begin(), list.begin() + n, CompareRobustChoice);
 
+    // Proven wins go first and proven losses last, whatever their visits
+    std::stable_partition(list.begin(), list.begin() + n,
+                          [](const Edge* e) { return e->proof == PROOF_WIN; });
+    std::stable_partition(list.begin(), list.begin() + n,
+                          [](const Edge* e) { return e->proof != PROOF_LOSS; });
+
     // Clear the global list of moves for root (Search::RootMoves)
     Search::RootMoves& rootMoves = thisThread->rootMoves;
     rootMoves.clear();
@@ -577,11 +703,31 @@ void MonteCarlo::emit_pv(Search::Worker*         worker,
         pv = "info depth 0 score " + UCI::value(pos.checkers() ? -VALUE_MATE : VALUE_DRAW);
     }
 
-    sync_cout << pv << sync_endl;
+    if (!silent)
+        sync_cout << pv << sync_endl;
 
     lastOutputTime = now();
 }
 
+/// MonteCarlo::publish_focus() tells the thread scheduler how much the visits of
+/// the root concentrate on its most visited move.
+void MonteCarlo::publish_focus(Brainlearn::ThreadPool& threads) const {
+
+    LOCK(this, root);
+
+    double total = 0.0;
+    for (int k = 0; k < root->number_of_sons; k++)
+        total += root->children[k]->visits;
+
+    if (total <= 0.0)
+        return;
+
+    const Edge* best = best_child(root, STAT_VISITS);
+
+    threads.mctsFocus    = int(1000 * best->visits / total);
+    threads.mctsBestMove = best->move.load().raw();
+}
+
 /// MonteCarlo::is_root() returns true when node is both the current node and the root
 inline bool MonteCarlo::is_root(const mctsNodeInfo* node) const {
     if (node != root)
@@ -877,18 +1023,237 @@ void MonteCarlo::print_children() {
 
     for (int k = root->number_of_sons - 1; k >= 0; k--)
     {
-        std::cout << "info string move " << k + 1 << " "
+        sync_cout << "info string move " << k + 1 << " "
                   << UCI::move(children[k]->move, pos.is_chess960())
 
                   << std::setprecision(2) << " win% " << children[k]->prior * 100
 
                   << std::fixed << std::setprecision(0) << " visits " << children[k]->visits
-                  << std::endl;
+
+                  << (children[k]->proof == PROOF_WIN    ? " proven win"
+                      : children[k]->proof == PROOF_DRAW ? " proven draw"
+                      : children[k]->proof == PROOF_LOSS ? " proven loss"
+                                                         : "")
+                  << sync_endl;
     }
 
     lastOutputTime = now();
 }
 
+namespace {
+
+// The tree file is the list of the nodes of the hash table, each followed by
+// its edges. Rewards in [0, 1] are stored as floats, the sums as doubles.
+constexpr char     TreeMagic[4] = {'M', 'K', 'M', 'T'};
+constexpr uint32_t TreeVersion  = 1;
+constexpr size_t   TreeHeader   = sizeof(TreeMagic) + 4 + 8;
+constexpr size_t   NodeRecord   = 8 + 8 + 8 + 2 + 4 + 1 + 1 + 2;
+constexpr size_t   EdgeRecord   = 2 + 8 + 4 + 8 + 4 + 1;
+constexpr size_t   SonsOffset   = NodeRecord - 2;
+
+template<typename T>
+void put(std::string& buf, T value) {
+    buf.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T>
+T get(const char*& p) {
+    T value;
+    std::memcpy(&value, p, sizeof(T));
+    p += sizeof(T);
+    return value;
+}
+
+// A stored move must be a real move, as no position is at hand to check its legality
+bool valid_move(Move m) { return m.is_ok() && m.from_sq() != m.to_sq(); }
+
+bool valid_proof(Proof p) { return p >= PROOF_NONE && p <= PROOF_LOSS; }
+
+bool valid_reward(double r) { return r >= 0.0 && r <= 1.0; }
+
+// Reads a node and its edges. Returns nullptr if a field is out of its range.
+mctsNodeInfo* read_node(const char* p) {
+
+    const uint64_t key1       = get<uint64_t>(p);
+    const uint64_t key2       = get<uint64_t>(p);
+    const int64_t  nodeVisits = get<int64_t>(p);
+    const Move     lastMove   = Move(get<uint16_t>(p));
+    const Value    ttValue    = Value(get<int32_t>(p));
+    const bool     ab         = get<uint8_t>(p) != 0;
+    const Proof    proof      = Proof(get<int8_t>(p));
+    const int      sons       = get<uint16_t>(p);
+
+    if (nodeVisits < 0 || (lastMove != Move::none() && !valid_move(lastMove))
+        || (ttValue != VALUE_NONE && std::abs(ttValue) > VALUE_INFINITE) || !valid_proof(proof))
+        return nullptr;
+
+    mctsNodeInfo* node = new mctsNodeInfo();
+
+    node->key1           = key1;
+    node->key2           = key2;
+    node->node_visits    = long(nodeVisits);
+    node->lastMove       = lastMove;
+    node->ttValue        = ttValue;
+    node->AB             = ab;
+    node->proof          = proof;
+    node->number_of_sons = sons;
+
+    for (int k = 0; k < sons; k++)
+    {
+        const Move   move            = Move(get<uint16_t>(p));
+        const double visits          = get<double>(p);
+        const float  prior           = get<float>(p);
+        const double actionValue     = get<double>(p);
+        const float  meanActionValue = get<float>(p);
+        const Proof  edgeProof       = Proof(get<int8_t>(p));
+
+        if (!valid_move(move) || !std::isfinite(visits) || visits < 0.0 || !valid_reward(prior)
+            || !(actionValue >= 0.0 && actionValue <= visits) || !valid_reward(meanActionValue)
+            || !valid_proof(edgeProof))
+        {
+            delete node;
+            return nullptr;
+        }
+
+        Edge* e            = node->children[k];
+        e->move            = move;
+        e->visits          = visits;
+        e->prior           = prior;
+        e->actionValue     = actionValue;
+        e->meanActionValue = meanActionValue;
+        e->proof           = edgeProof;
+    }
+
+    return node;
+}
+
+}  // namespace
+
+bool save_tree(const std::string& filename) {
+
+    std::string buf;
+    buf.reserve(TreeHeader + MCTS.size() * (NodeRecord + 32 * EdgeRecord));
+
+    buf.append(TreeMagic, sizeof(TreeMagic));
+    put<uint32_t>(buf, TreeVersion);
+    put<uint64_t>(buf, MCTS.size());
+
+    for (const auto& [key, node] : MCTS)
+    {
+        const int sons = std::clamp(node->number_of_sons.load(), 0, MAX_CHILDREN);
+
+        put<uint64_t>(buf, node->key1);
+        put<uint64_t>(buf, node->key2);
+        put<int64_t>(buf, node->node_visits);
+        put<uint16_t>(buf, node->lastMove.load().raw());
+        put<int32_t>(buf, node->ttValue);
+        put<uint8_t>(buf, node->AB);
+        put<int8_t>(buf, node->proof);
+        put<uint16_t>(buf, uint16_t(sons));
+
+        for (int k = 0; k < sons; k++)
+        {
+            const Edge* e = node->children[k];
+            put<uint16_t>(buf, e->move.load().raw());
+            put<double>(buf, e->visits);
+            put<float>(buf, float(e->prior));
+            put<double>(buf, e->actionValue);
+            put<float>(buf, float(e->meanActionValue));
+            put<int8_t>(buf, e->proof);
+        }
+    }
+
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    out.write(buf.data(), std::streamsize(buf.size()));
+
+    return bool(out);
+}
+
+bool load_tree(const std::string& filename, size_t threadCount) {
+
+    std::ifstream in(filename, std::ios::binary);
+    if (!in)
+        return false;
+
+    const std::string buf((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    if (buf.size() < TreeHeader || !std::equal(TreeMagic, TreeMagic + 4, buf.data()))
+        return false;
+
+    const char* p = buf.data() + sizeof(TreeMagic);
+    if (get<uint32_t>(p) != TreeVersion)
+        return false;
+
+    const uint64_t count = get<uint64_t>(p);
+
+    // Every node takes at least a record, so a bigger count is corrupt and must
+    // not size the allocations below
+    if (count > (buf.size() - TreeHeader) / NodeRecord)
+        return false;
+
+    // Find where every node starts, which also checks the size of the file
+    std::vector<size_t> offsets(count);
+    size_t              offset = TreeHeader;
+
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        if (offset + NodeRecord > buf.size())
+            return false;
+
+        const char* sons = buf.data() + offset + SonsOffset;
+        const int   n    = get<uint16_t>(sons);
+
+        if (n > MAX_CHILDREN)
+            return false;
+
+        offsets[i] = offset;
+        offset += NodeRecord + n * EdgeRecord;
+    }
+
+    if (offset != buf.size())
+        return false;
+
+    // Every node allocates all its edges, so building them is the slow part
+    std::vector<mctsNodeInfo*> nodes(count);
+    std::atomic<uint64_t>      next{0};
+    std::vector<std::thread>   workers;
+
+    for (size_t t = 0; t < std::max(threadCount, size_t(1)); ++t)
+        workers.emplace_back([&]() {
+            for (uint64_t i; (i = next.fetch_add(1)) < count;)
+                nodes[i] = read_node(buf.data() + offsets[i]);
+        });
+
+    for (std::thread& th : workers)
+        th.join();
+
+    // Nothing is linked into the tree unless all the nodes are valid and unique.
+    // A position has several nodes during a count, which differ in key2 only.
+    std::vector<std::pair<Key, Key>> keys;
+    for (const mctsNodeInfo* node : nodes)
+        if (node)
+            keys.emplace_back(node->key1, node->key2);
+
+    std::sort(keys.begin(), keys.end());
+
+    if (keys.size() != count || std::adjacent_find(keys.begin(), keys.end()) != keys.end())
+    {
+        for (mctsNodeInfo* node : nodes)
+            delete node;
+        return false;
+    }
+
+    MCTS.clear();
+    MCTS.reserve(count);
+
+    for (mctsNodeInfo* node : nodes)
+        MCTS.insert(make_pair(node->key1, node));
+
+    Memory::add(Memory::MCTS_TREE, int64_t(count * MCTS_NODE_BYTES));
+
+    return true;
+}
+
 // List of FIXME/TODO for the monte-carlo branch
 //
 // 1. ttMove = Move::none() in generate_moves() ?
@@ -20,8 +20,10 @@
 #define MONTECARLO_H_INCLUDED
 
 #include <cmath>
+#include <string>
 #include <unordered_map>
 
+#include "../memory.h"
 #include "../position.h"
 #include "../thread.h"
 
@@ -41,6 +43,15 @@ enum EdgeStatistic {
     STAT_PRIOR
 };
 
+// Game-theoretical result proven by the MCTS-Solver, from the point of view of
+// the side to move in a node, and of the side playing the move of an edge
+enum Proof : int8_t {
+    PROOF_NONE,
+    PROOF_WIN,
+    PROOF_DRAW,
+    PROOF_LOSS
+};
+
 ///////////////////////////////////////////////////////////////////////////////////////
 /// Edge struct stores the statistics of one edge between nodes in the Monte-Carlo tree
 ///////////////////////////////////////////////////////////////////////////////////////
@@ -51,7 +62,8 @@ struct Edge {
         visits(0),
         prior(REWARD_NONE),
         actionValue(REWARD_NONE),
-        meanActionValue(REWARD_NONE) {}
+        meanActionValue(REWARD_NONE),
+        proof(PROOF_NONE) {}
 
     //Prevent copying of this struct type
     Edge(const Edge&)            = delete;
@@ -62,6 +74,7 @@ struct Edge {
     std::atomic<Reward> prior;
     std::atomic<Reward> actionValue;
     std::atomic<Reward> meanActionValue;
+    std::atomic<Proof>  proof;
 };
 
 extern size_t                           mctsThreads;
@@ -149,6 +162,7 @@ struct mctsNodeInfo {
     std::atomic<Move>  lastMove       = Move::none();  // the move between the parent and this node
     std::atomic<Value> ttValue        = VALUE_NONE;
     std::atomic<bool>  AB             = false;
+    std::atomic<Proof> proof          = PROOF_NONE;  // proven result for the side to move
     EdgeArray          children;
 };
 
@@ -159,6 +173,11 @@ mctsNodeInfo* get_node(const MonteCarlo* mcts, const Position& pos);
 // The Monte-Carlo tree is stored implicitly in one big hash table
 ///////////////////////////////////////////////////////////////////////////////////////
 typedef std::unordered_multimap<Key, mctsNodeInfo*> MCTS_MAP_BASE;
+
+// A node with all its edges, and the node of the hash table pointing to it
+constexpr size_t MCTS_NODE_BYTES =
+  sizeof(mctsNodeInfo) + MAX_CHILDREN * sizeof(Edge) + sizeof(Key) + 2 * sizeof(void*);
+
 class MCTSHashTable: public MCTS_MAP_BASE {
    public:
     ~MCTSHashTable() { clear(); }
@@ -170,11 +189,18 @@ class MCTSHashTable: public MCTS_MAP_BASE {
                 delete it->second;
         }
 
+        Memory::add(Memory::MCTS_TREE, -int64_t(size() * MCTS_NODE_BYTES));
         MCTS_MAP_BASE::clear();
     }
 };
 extern MCTSHashTable MCTS;
 
+// Write the Monte-Carlo tree to a file, and read it back in place of the
+// current tree with all its statistics, so that a long analysis survives a
+// restart. Loading builds the nodes with the given number of threads.
+bool save_tree(const std::string& filename);
+bool load_tree(const std::string& filename, size_t threadCount);
+
 ///////////////////////////////////////////////////////////////////////////////////////
 // Main MCTS search class
 ///////////////////////////////////////////////////////////////////////////////////////
@@ -206,6 +232,10 @@ class MonteCarlo {
     Value         backup(Reward r, bool AB_Mode);
     Edge*         best_child(mctsNodeInfo* node, EdgeStatistic statistic) const;
 
+    // The MCTS-Solver
+    void prove_terminal(mctsNodeInfo* node) const;
+    void update_proof(mctsNodeInfo* node) const;
+
     // The UCB formula
     double ucb(const Edge* edge, long fatherVisits, bool priorMode) const;
 
@@ -232,8 +262,12 @@ class MonteCarlo {
 
     // Output of results
     [[nodiscard]] bool should_emit_pv(bool isMainThread) const;
-    void emit_pv(Search::Worker* worker, Brainlearn::ThreadPool& threads, TranspositionTable& tt);
+    void emit_pv(Search::Worker*         worker,
+                 Brainlearn::ThreadPool& threads,
+                 TranspositionTable&     tt,
+                 bool                    silent);
     void print_children();
+    void publish_focus(Brainlearn::ThreadPool& threads) const;
 
    private:
     Position&                   pos;  // The current position of the tree
@@ -243,6 +277,7 @@ class MonteCarlo {
     // Counters and statistics
     int       ply{};
     int       maximumPly{};
+    uint64_t  playouts{};
     TimePoint startTime{};
     TimePoint lastOutputTime{};
 
@@ -0,0 +1,217 @@
+/*
+  Brainlearn, a UCI chess playing engine derived from Stockfish
+  Copyright (C) 2004-2024 Andrea Manzo, K.Kiniama and Brainlearn developers (see AUTHORS file)
+
+  Brainlearn is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Brainlearn is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "memory.h"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+namespace Brainlearn::Memory {
+
+namespace {
+
+constexpr const char* Names[SUBSYSTEM_NB] = {"tt",       "workers",  "states",   "networks",
+                                             "learning", "mcts",     "books",    "livebook",
+                                             "bitbases", "analysis"};
+
+struct Region {
+    Subsystem subsystem;
+    size_t    bytes;
+};
+
+struct Usage {
+    double reserved = 0, resident = 0, huge = 0;
+    bool   mapped   = false;  // Resident and huge figures come from the kernel
+};
+
+struct Vma {
+    uintptr_t start, end;
+    double    rss, huge;  // In bytes
+};
+
+// The registry is never destroyed, because global tables untrack themselves
+// from their destructors at exit.
+struct Registry {
+    std::mutex                              mutex;
+    std::unordered_map<const void*, Region> regions;
+    std::atomic<int64_t>                    counters[SUBSYSTEM_NB] = {};
+};
+
+Registry& registry() {
+    static Registry* r = new Registry();
+    return *r;
+}
+
+// Reads the resident and the transparent huge page sizes of every mapping
+std::vector<Vma> read_smaps() {
+
+    std::vector<Vma> vmas;
+
+#if defined(__linux__)
+    std::ifstream in("/proc/self/smaps");
+    std::string   line;
+
+    while (std::getline(in, line))
+    {
+        std::istringstream ss(line);
+        std::string        field;
+        ss >> field;
+
+        if (field.empty())
+            continue;
+
+        if (field.back() != ':')
+        {
+            // A mapping header: "start-end perms offset dev inode path"
+            const size_t dash = field.find('-');
+            if (dash == std::string::npos)
+                continue;
+
+            vmas.push_back({std::stoull(field.substr(0, dash), nullptr, 16),
+                            std::stoull(field.substr(dash + 1), nullptr, 16), 0, 0});
+            continue;
+        }
+
+        double kb = 0;
+        ss >> kb;
+
+        if (vmas.empty())
+            continue;
+
+        if (field == "Rss:")
+            vmas.back().rss = kb * 1024;
+
+        else if (field == "AnonHugePages:" || field == "FilePmdMapped:"
+                 || field == "ShmemPmdMapped:" || field == "Private_Hugetlb:"
+                 || field == "Shared_Hugetlb:")
+            vmas.back().huge += kb * 1024;
+    }
+#endif
+
+    return vmas;
+}
+
+std::string format(double bytes) {
+
+    std::ostringstream ss;
+    ss << std::fixed << std::setprecision(1) << std::setw(8) << bytes / (1024 * 1024) << " MiB";
+    return ss.str();
+}
+
+}  // namespace
+
+void track(Subsystem s, const void* p, size_t bytes) {
+
+    if (!p || !bytes)
+        return;
+
+    Registry&                   r = registry();
+    std::lock_guard<std::mutex> lk(r.mutex);
+    r.regions[p] = {s, bytes};
+}
+
+void untrack(const void* p) {
+
+    if (!p)
+        return;
+
+    Registry&                   r = registry();
+    std::lock_guard<std::mutex> lk(r.mutex);
+    r.regions.erase(p);
+}
+
+void add(Subsystem s, int64_t bytes) { registry().counters[s] += bytes; }
+
+void set(Subsystem s, size_t bytes) { registry().counters[s] = int64_t(bytes); }
+
+std::string report() {
+
+    const std::vector<Vma> vmas = read_smaps();
+    Usage                  usage[SUBSYSTEM_NB];
+    Registry&              r = registry();
+
+    {
+        std::lock_guard<std::mutex> lk(r.mutex);
+
+        // A region shares its mappings with others when it does not fill them,
+        // for instance a block of the heap: it gets its share of their pages.
+        for (const auto& [p, region] : r.regions)
+        {
+            Usage&          u     = usage[region.subsystem];
+            const uintptr_t begin = uintptr_t(p), end = begin + region.bytes;
+
+            u.reserved += region.bytes;
+            u.mapped = !vmas.empty();
+
+            for (const Vma& vma : vmas)
+            {
+                const uintptr_t lo = std::max(begin, vma.start), hi = std::min(end, vma.end);
+
+                if (lo >= hi)
+                    continue;
+
+                const double share = double(hi - lo) / double(vma.end - vma.start);
+                u.resident += share * vma.rss;
+                u.huge += share * vma.huge;
+            }
+        }
+    }
+
+    for (int s = 0; s < SUBSYSTEM_NB; ++s)
+    {
+        const double bytes = double(std::max(r.counters[s].load(), int64_t(0)));
+        usage[s].reserved += bytes;
+        usage[s].resident += bytes;
+    }
+
+    std::ostringstream ss;
+    Usage              total;
+
+    ss << "info string memory " << std::left << std::setw(9) << "subsystem" << std::right
+       << std::setw(13) << "reserved" << std::setw(13) << "resident" << std::setw(13)
+       << "hugepages";
+
+    for (int s = 0; s < SUBSYSTEM_NB; ++s)
+    {
+        const Usage& u = usage[s];
+
+        ss << "\ninfo string memory " << std::left << std::setw(9) << Names[s] << std::right
+           << " " << format(u.reserved) << " " << format(u.resident);
+
+        if (u.mapped)
+            ss << " " << format(u.huge) << " " << int(100 * u.huge / u.reserved) << "%";
+
+        total.reserved += u.reserved;
+        total.resident += u.resident;
+        total.huge += u.huge;
+    }
+
+    ss << "\ninfo string memory " << std::left << std::setw(9) << "total" << std::right << " "
+       << format(total.reserved) << " " << format(total.resident) << " " << format(total.huge)
+       << " " << (total.reserved > 0 ? int(100 * total.huge / total.reserved) : 0) << "%";
+
+    return ss.str();
+}
+
+}  // namespace Brainlearn::Memory
@@ -0,0 +1,59 @@
+/*
+  Brainlearn, a UCI chess playing engine derived from Stockfish
+  Copyright (C) 2004-2024 Andrea Manzo, K.Kiniama and Brainlearn developers (see AUTHORS file)
+
+  Brainlearn is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Brainlearn is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef MEMORY_H_INCLUDED
+#define MEMORY_H_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Accounting of the memory of every subsystem, filled in by their allocation
+// paths. Big blocks (tables, networks, mapped files) are registered as regions,
+// whose resident size and huge page coverage are read from /proc/self/smaps on
+// Linux. The subsystems made of many small heap objects keep a byte counter;
+// those objects are written when they are created, so they are counted as
+// resident.
+namespace Brainlearn::Memory {
+
+enum Subsystem {
+    TT,
+    WORKERS,   // Search::Worker, mostly the history tables
+    STATES,    // StateInfo of the game history, with their accumulators
+    NETWORKS,  // NNUE feature transformers and layers
+    LEARNING,  // The experience table LD
+    MCTS_TREE,
+    BOOKS,  // Mapped Polyglot and CTG files
+    LIVEBOOK,
+    BITBASES,
+    ANALYSIS_CACHE,
+    SUBSYSTEM_NB
+};
+
+void track(Subsystem s, const void* p, size_t bytes);
+void untrack(const void* p);
+
+void add(Subsystem s, int64_t bytes);
+void set(Subsystem s, size_t bytes);
+
+// One "info string" line per subsystem and one for the total
+std::string report();
+
+}  // namespace Brainlearn::Memory
+
+#endif  // #ifndef MEMORY_H_INCLUDED
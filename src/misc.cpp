@@ -53,9 +53,11 @@ using fun8_t = bool (*)(HANDLE, BOOL, PTOKEN_PRIVILEGES, DWORD, PTOKEN_PRIVILEGE
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <condition_variable>
 #include <mutex>
 #include <sstream>
 #include <string_view>
+#include <thread>
 //from Brainlearn begin
 #include <algorithm>
 #include <stdarg.h>
@@ -399,24 +401,220 @@ void dbg_print() {
 }
 
 
-// Used to serialize access to std::cout
-// to avoid multiple threads writing at the same time.
+namespace {
+
+// The output of sync_cout is pushed by the producers on a lock-free stack, and
+// written to std::cout by a single thread, so that a slow reader of stdout
+// never stalls the search. The producers only take the mutex to wake up the
+// writer when it sleeps, and never while it writes.
+class OutputWriter {
+
+    struct Node {
+        std::string text;
+        Node*       next;
+    };
+
+    OutputWriter() :
+        thread(&OutputWriter::idle_loop, this) {}
+
+    ~OutputWriter() {
+        {
+            std::lock_guard<std::mutex> lk(mutex);
+            exit     = true;
+            sleeping = false;
+        }
+        cv.notify_one();
+        thread.join();
+    }
+
+    void idle_loop();
+    void write(Node* list);
+
+    std::atomic<Node*>    head{nullptr};
+    std::atomic<bool>     sleeping{false};
+    bool                  exit = false;
+    std::atomic<uint64_t> pushed{0}, written{0};
+    std::mutex            mutex;
+    std::condition_variable cv;
+    std::thread             thread;  // Last, so that it starts once the rest is set
+
+   public:
+    static OutputWriter& instance() {
+        static OutputWriter w;
+        return w;
+    }
+
+    void push(std::string&& text) {
+
+        Node* n = new Node{std::move(text), head.load(std::memory_order_relaxed)};
+
+        while (!head.compare_exchange_weak(n->next, n))
+        {}
+
+        ++pushed;
+
+        // Paired with the check of 'head' in idle_loop(), either the writer
+        // sees the new node, or we see that it sleeps and wake it up.
+        if (sleeping.exchange(false))
+        {
+            std::lock_guard<std::mutex> lk(mutex);
+            cv.notify_one();
+        }
+    }
+
+    // Waits until the output pushed so far has been written
+    void flush() {
+
+        const uint64_t target = pushed;
+
+        while (written < target)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+};
+
+void OutputWriter::idle_loop() {
+
+    while (true)
+    {
+        if (Node* list = head.exchange(nullptr))
+        {
+            write(list);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lk(mutex);
+
+        if (exit)
+        {
+            if (Node* list = head.exchange(nullptr))
+                write(list);
+            return;
+        }
+
+        sleeping = true;
+
+        if (head.load())
+        {
+            sleeping = false;
+            continue;
+        }
+
+        cv.wait(lk, [&] { return !sleeping; });
+    }
+}
+
+// The key of the info lines that a later line with the same key supersedes:
+// the PV of each multipv index and the current move. Other lines are barriers,
+// no line is dropped across them.
+std::string_view superseded_key(std::string_view line) {
+
+    if (line.substr(0, 5) != "info " || line.substr(0, 12) == "info string ")
+        return {};
+
+    if (line.find(" currmove ") != std::string_view::npos)
+        return "currmove";
+
+    if (line.find(" pv ") == std::string_view::npos)
+        return {};
+
+    const size_t idx = line.find(" multipv ");
+    if (idx == std::string_view::npos)
+        return " 1 ";
+
+    // The multipv index, with its surrounding spaces
+    const size_t start = idx + 8, end = line.find(' ', start + 1);
+    return end == std::string_view::npos ? line.substr(start)
+                                         : line.substr(start, end - start + 1);
+}
+
+// Writes a batch of the queue, which holds the newest text first, with a
+// single write to the stream.
+void OutputWriter::write(Node* list) {
+
+    std::vector<Node*> nodes;
+    for (; list; list = list->next)
+        nodes.push_back(list);
+
+    std::vector<std::string_view> lines;
+    for (auto it = nodes.rbegin(); it != nodes.rend(); ++it)
+    {
+        std::string_view text = (*it)->text;
+
+        for (size_t nl; (nl = text.find('\n')) != std::string_view::npos;)
+        {
+            lines.push_back(text.substr(0, nl + 1));
+            text.remove_prefix(nl + 1);
+        }
+
+        if (!text.empty())
+            lines.push_back(text);
+    }
+
+    std::vector<bool>             keep(lines.size(), true);
+    std::vector<std::string_view> seen;
+
+    for (size_t i = lines.size(); i-- > 0;)
+    {
+        const std::string_view key = superseded_key(lines[i]);
+
+        if (key.empty())
+            seen.clear();
+        else if (std::find(seen.begin(), seen.end(), key) != seen.end())
+            keep[i] = false;
+        else
+            seen.push_back(key);
+    }
+
+    std::string out;
+    for (size_t i = 0; i < lines.size(); ++i)
+        if (keep[i])
+            out += lines[i];
+
+    std::cout << out << std::flush;
+
+    written += nodes.size();
+
+    for (Node* n : nodes)
+        delete n;
+}
+
+}  // namespace
+
+
+// Each thread formats its output in its own buffer, and the whole text is
+// queued for the writer thread once complete.
+std::ostream& sync_stream() {
+
+    thread_local std::ostringstream ss;
+    return ss;
+}
+
 std::ostream& operator<<(std::ostream& os, SyncCout sc) {
 
-    static std::mutex m;
+    auto& ss = static_cast<std::ostringstream&>(os);
 
     if (sc == IO_LOCK)
-        m.lock();
+    {
+        ss.str("");
+        ss.copyfmt(std::ios(nullptr));  // Default formatting for every message
+    }
 
     if (sc == IO_UNLOCK)
-        m.unlock();
+        OutputWriter::instance().push(ss.str());
 
     return os;
 }
 
+void sync_flush() { OutputWriter::instance().flush(); }
+
 
 // Trampoline helper to avoid moving Logger to misc.h
-void start_logger(const std::string& fname) { Logger::start(fname); }
+void start_logger(const std::string& fname) {
+
+    // The writer thread must not write while std::cout is redirected
+    sync_flush();
+    Logger::start(fname);
+}
 
 
 #ifdef NO_PREFETCH
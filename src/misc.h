@@ -84,8 +84,12 @@ enum SyncCout {
     IO_UNLOCK
 };
 std::ostream& operator<<(std::ostream&, SyncCout);
+std::ostream& sync_stream();
+void          sync_flush();
 
-#define sync_cout std::cout << IO_LOCK
+// The output is queued and written to std::cout by a dedicated thread, so the
+// text of a sync_cout must be complete before its sync_endl.
+#define sync_cout sync_stream() << IO_LOCK
 #define sync_endl std::endl << IO_UNLOCK
 
 
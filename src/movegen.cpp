@@ -28,20 +28,26 @@ namespace Brainlearn {
 
 namespace {
 
+// In chess every queen promotion is generated with the captures. In Makruk the
+// promotions without capture are quiet moves, see Position::capture_stage().
 template<GenType Type, Direction D, bool Enemy>
 ExtMove* make_promotions(ExtMove* moveList, [[maybe_unused]] Square to) {
 
-    constexpr bool all = Type == EVASIONS || Type == NON_EVASIONS;
+    constexpr bool all   = Type == EVASIONS || Type == NON_EVASIONS;
+    constexpr bool stage = MakrukOnly && !Enemy ? Type == QUIETS : Type == CAPTURES;
 
-    if constexpr (Type == CAPTURES || all)
+    if constexpr (stage || all)
         *moveList++ = Move::make<PROMOTION>(to - D, to, QUEEN);
 
     return moveList;
 }
 
 
+// Generates the moves of the given pawns. The captures are restricted to the
+// target squares too, so that a single pinned pawn can be kept on its pin ray.
 template<Color Us, GenType Type>
-ExtMove* generate_pawn_moves(const Position& pos, ExtMove* moveList, Bitboard target) {
+ExtMove*
+generate_pawn_moves(const Position& pos, ExtMove* moveList, Bitboard target, Bitboard pawns) {
 
     constexpr Color     Them     = ~Us;
     constexpr Bitboard  TRank6BB = (Us == WHITE ? Rank6BB : Rank3BB);
@@ -51,20 +57,15 @@ ExtMove* generate_pawn_moves(const Position& pos, ExtMove* moveList, Bitboard ta
     constexpr Direction UpLeft   = (Us == WHITE ? NORTH_WEST : SOUTH_EAST);
 
     const Bitboard emptySquares = ~pos.pieces();
-    const Bitboard enemies      = Type == EVASIONS ? pos.checkers() : pos.pieces(Them);
+    const Bitboard enemies = (Type == EVASIONS ? pos.checkers() : pos.pieces(Them)) & target;
 
-    Bitboard pawnsOn5    = pos.pieces(Us, PAWN) & TRank5BB;
-    Bitboard pawnsNotOn5 = pos.pieces(Us, PAWN) & ~TRank5BB;
+    Bitboard pawnsOn5    = pawns & TRank5BB;
+    Bitboard pawnsNotOn5 = pawns & ~TRank5BB;
 
     // Single and double pawn pushes, no promotions
     if constexpr (Type != CAPTURES)
     {
-        Bitboard b1 = shift<Up>(pawnsNotOn5) & emptySquares;
-
-        if constexpr (Type == EVASIONS)  // Consider only blocking squares
-        {
-            b1 &= target;
-        }
+        Bitboard b1 = shift<Up>(pawnsNotOn5) & emptySquares & target;
 
         if constexpr (Type == QUIET_CHECKS)
         {
@@ -88,10 +89,8 @@ ExtMove* generate_pawn_moves(const Position& pos, ExtMove* moveList, Bitboard ta
     {
         Bitboard b1 = shift<UpRight>(pawnsOn5) & enemies;
         Bitboard b2 = shift<UpLeft>(pawnsOn5) & enemies;
-        Bitboard b3 = shift<Up>(pawnsOn5) & emptySquares;
-
-        if constexpr (Type == EVASIONS)
-            b3 &= target;
+        Bitboard b3 = shift<Up>(pawnsOn5) & emptySquares
+                    & (Type == CAPTURES && !MakrukOnly ? ~0ULL : target);
 
         while (b1)
             moveList = make_promotions<Type, UpRight, true>(moveList, pop_lsb(b1));
@@ -126,8 +125,11 @@ ExtMove* generate_pawn_moves(const Position& pos, ExtMove* moveList, Bitboard ta
 }
 
 
+// Generates the moves of the pieces of type Pt. The pinned pieces, if any, can
+// only move along the line joining them to their king.
 template<Color Us, PieceType Pt, bool Checks>
-ExtMove* generate_moves(const Position& pos, ExtMove* moveList, Bitboard target) {
+ExtMove*
+generate_moves(const Position& pos, ExtMove* moveList, Bitboard target, Bitboard pinned = 0) {
 
     static_assert(Pt != KING && Pt != PAWN, "Unsupported piece type in generate_moves()");
 
@@ -138,6 +140,9 @@ ExtMove* generate_moves(const Position& pos, ExtMove* moveList, Bitboard target)
         Square   from = pop_lsb(bb);
         Bitboard b    = attacks_bb<Pt>(from, pos.pieces()) & target;
 
+        if (pinned & from)
+            b &= line_bb(pos.square<KING>(Us), from);
+
         // To check, you either move freely a blocker or make a direct check.
         if (Checks)
             b &= pos.check_squares(Pt);
@@ -167,7 +172,7 @@ ExtMove* generate_all(const Position& pos, ExtMove* moveList) {
                : Type == CAPTURES     ? pos.pieces(~Us)
                                       : ~pos.pieces();  // QUIETS || QUIET_CHECKS
 
-        moveList = generate_pawn_moves<Us, Type>(pos, moveList, target);
+        moveList = generate_pawn_moves<Us, Type>(pos, moveList, target, pos.pieces(Us, PAWN));
         moveList = generate_moves<Us, KNIGHT, Checks>(pos, moveList, target);
         moveList = generate_moves<Us, BISHOP, Checks>(pos, moveList, target);
         moveList = generate_moves<Us, ROOK, Checks>(pos, moveList, target);
@@ -178,7 +183,7 @@ ExtMove* generate_all(const Position& pos, ExtMove* moveList) {
     {
         Bitboard b = attacks_bb<KING>(ksq) & (Type == EVASIONS ? ~pos.pieces(Us) : target);
         if (Checks)
-            b &= ~attacks_bb<QUEEN>(pos.square<KING>(~Us));
+            b &= ~attacks_bb<MakrukOnly ? ROOK : QUEEN>(pos.square<KING>(~Us));
 
         while (b)
             *moveList++ = Move(ksq, pop_lsb(b));
@@ -187,6 +192,115 @@ ExtMove* generate_all(const Position& pos, ExtMove* moveList) {
     return moveList;
 }
 
+
+// Returns the squares attacked by the opponent, computed with our king removed
+// from the board so that it cannot step back along the ray of a checking rook.
+// Mirrors the attacks seen by Position::attackers_to().
+template<Color Us>
+Bitboard king_danger(const Position& pos) {
+
+    constexpr Color Them     = ~Us;
+    const Bitboard  occupied = pos.pieces() ^ pos.square<KING>(Us);
+
+    Bitboard danger = pos.leaper_attacks(Them);
+
+    for (Bitboard b = pos.pieces(Them, ROOK, QUEEN); b;)
+        danger |= attacks_bb<ROOK>(pop_lsb(b), occupied);
+
+    return danger;
+}
+
+
+// Generates the legal moves directly, without testing each move afterwards.
+// Makruk has no castling and no en passant, so it is enough to keep the king
+// out of the danger squares, to block or capture a single checker and to keep
+// the pinned pieces on their pin rays.
+template<Color Us>
+ExtMove* generate_legal(const Position& pos, ExtMove* moveList) {
+
+    const Square   ksq      = pos.square<KING>(Us);
+    const Bitboard checkers = pos.checkers();
+    const Bitboard pinned   = pos.blockers_for_king(Us) & pos.pieces(Us);
+
+    // Skip generating non-king moves when in double check
+    if (!more_than_one(checkers))
+    {
+        const Bitboard target =
+          (checkers ? between_bb(ksq, lsb(checkers)) : ~pos.pieces(Us)) & ~pos.pieces(~Us, KING);
+
+        moveList = checkers ? generate_pawn_moves<Us, EVASIONS>(pos, moveList, target,
+                                                                pos.pieces(Us, PAWN) & ~pinned)
+                            : generate_pawn_moves<Us, NON_EVASIONS>(pos, moveList, target,
+                                                                    pos.pieces(Us, PAWN) & ~pinned);
+
+        for (Bitboard b = pos.pieces(Us, PAWN) & pinned; b;)
+        {
+            const Square from = pop_lsb(b);
+            moveList = checkers ? generate_pawn_moves<Us, EVASIONS>(
+                                    pos, moveList, target & line_bb(ksq, from), square_bb(from))
+                                : generate_pawn_moves<Us, NON_EVASIONS>(
+                                    pos, moveList, target & line_bb(ksq, from), square_bb(from));
+        }
+
+        moveList = generate_moves<Us, KNIGHT, false>(pos, moveList, target, pinned);
+        moveList = generate_moves<Us, BISHOP, false>(pos, moveList, target, pinned);
+        moveList = generate_moves<Us, ROOK, false>(pos, moveList, target, pinned);
+        moveList = generate_moves<Us, QUEEN, false>(pos, moveList, target, pinned);
+    }
+
+    Bitboard b = attacks_bb<KING>(ksq) & ~pos.pieces(Us) & ~king_danger<Us>(pos);
+
+    while (b)
+        *moveList++ = Move(ksq, pop_lsb(b));
+
+    return moveList;
+}
+
+
+// Early-exit version of generate_legal(): returns as soon as a legal move is
+// found. The king moves are tried first since they are the cheapest to test.
+template<Color Us>
+bool has_legal_move(const Position& pos) {
+
+    constexpr Color     Them = ~Us;
+    constexpr Direction Up   = pawn_push(Us);
+
+    const Square   ksq      = pos.square<KING>(Us);
+    const Bitboard checkers = pos.checkers();
+    const Bitboard pinned   = pos.blockers_for_king(Us) & pos.pieces(Us);
+
+    if (attacks_bb<KING>(ksq) & ~pos.pieces(Us) & ~king_danger<Us>(pos))
+        return true;
+
+    if (more_than_one(checkers))
+        return false;
+
+    const Bitboard target =
+      (checkers ? between_bb(ksq, lsb(checkers)) : ~pos.pieces(Us)) & ~pos.pieces(Them, KING);
+    const Bitboard enemies = (checkers ? checkers : pos.pieces(Them)) & target;
+
+    // Unpinned pawns are tested all at once, pushes (promotions included) and captures
+    const Bitboard pawns = pos.pieces(Us, PAWN) & ~pinned;
+    if ((shift<Up>(pawns) & ~pos.pieces() & target) | (pawn_attacks_bb<Us>(pawns) & enemies))
+        return true;
+
+    for (Bitboard bb = pos.pieces(Us) & ~pos.pieces(KING) & ~pawns; bb;)
+    {
+        const Square from = pop_lsb(bb);
+        Bitboard     b    = type_of(pos.piece_on(from)) == PAWN
+                            ? (shift<Up>(square_bb(from)) & ~pos.pieces()) | (pawn_attacks_bb(Us, from) & enemies)
+                            : attacks_bb(type_of(pos.piece_on(from)), from, pos.pieces());
+
+        if (pinned & from)
+            b &= line_bb(ksq, from);
+
+        if (b & target)
+            return true;
+    }
+
+    return false;
+}
+
 }  // namespace
 
 
@@ -218,26 +332,24 @@ template ExtMove* generate<QUIET_CHECKS>(const Position&, ExtMove*);
 template ExtMove* generate<NON_EVASIONS>(const Position&, ExtMove*);
 
 
-// generate<LEGAL> generates all the legal moves in the given position
+// generate<LEGAL> generates all the legal moves in the given position. Pins and
+// king danger squares are resolved during generation, so no move needs to be
+// tested with Position::legal() afterwards.
 
 template<>
 ExtMove* generate<LEGAL>(const Position& pos, ExtMove* moveList) {
 
-    Color    us     = pos.side_to_move();
-    Bitboard pinned = pos.blockers_for_king(us) & pos.pieces(us);
-    Square   ksq    = pos.square<KING>(us);
-    ExtMove* cur    = moveList;
+    return pos.side_to_move() == WHITE ? generate_legal<WHITE>(pos, moveList)
+                                       : generate_legal<BLACK>(pos, moveList);
+}
 
-    moveList =
-      pos.checkers() ? generate<EVASIONS>(pos, moveList) : generate<NON_EVASIONS>(pos, moveList);
-    while (cur != moveList)
-        if (((pinned & cur->from_sq()) || cur->from_sq() == ksq)
-            && !pos.legal(*cur))
-            *cur = *(--moveList);
-        else
-            ++cur;
 
-    return moveList;
+// has_any_legal_move() returns true if the side to move has at least one legal
+// move. It is much cheaper than MoveList<LEGAL>(pos).size() when only the
+// emptiness of the move list matters (mate and stalemate detection).
+bool has_any_legal_move(const Position& pos) {
+
+    return pos.side_to_move() == WHITE ? has_legal_move<WHITE>(pos) : has_legal_move<BLACK>(pos);
 }
 
 }  // namespace Brainlearn
@@ -26,6 +26,10 @@
 #include "bitboard.h"
 #include "position.h"
 
+#if defined(USE_AVX2)
+    #include <immintrin.h>
+#endif
+
 namespace Brainlearn {
 
 namespace {
@@ -74,6 +78,83 @@ void partial_insertion_sort(ExtMove* begin, ExtMove* end, int limit) {
         }
 }
 
+// Sums the history scores of the quiet moves into 'out'. With AVX2 the moves
+// are staged as arrays of table indices, and the values of eight moves are
+// gathered from every table at once. The tables hold int16_t, so 32 bits are
+// gathered and sign-extended from their lower half: reading two bytes past the
+// last entry of a table stays inside the Worker that owns it.
+void quiet_histories(const Position&         pos,
+                     const ExtMove*          begin,
+                     const ExtMove*          end,
+                     const ButterflyHistory* mainHistory,
+                     const PawnHistory*      pawnHistory,
+                     const PieceToHistory**  continuationHistory,
+                     int*                    out) {
+
+    const int n = int(end - begin);
+
+#if defined(USE_AVX2)
+    alignas(32) int pieceTo[MAX_MOVES + 8];
+    alignas(32) int fromTo[MAX_MOVES + 8];
+
+    for (int i = 0; i < n; ++i)
+    {
+        pieceTo[i] = history_index(pos.moved_piece(begin[i])) * SQUARE_NB + begin[i].to_sq();
+        fromTo[i]  = begin[i].from_to();
+    }
+
+    for (int i = n; i % 8; ++i)
+        pieceTo[i] = fromTo[i] = 0;
+
+    const auto table = [](const auto& t) { return reinterpret_cast<const int*>(&t); };
+
+    const int* mh = table((*mainHistory)[pos.side_to_move()]);
+    const int* ph = table((*pawnHistory)[pawn_structure_index(pos)]);
+    const int* ch[] = {table(*continuationHistory[0]), table(*continuationHistory[1]),
+                       table(*continuationHistory[2]), table(*continuationHistory[3]),
+                       table(*continuationHistory[5])};
+
+    const auto gather = [](const int* t, __m256i idx) {
+        const __m256i v = _mm256_i32gather_epi32(t, idx, 2);
+        return _mm256_srai_epi32(_mm256_slli_epi32(v, 16), 16);
+    };
+
+    for (int i = 0; i < n; i += 8)
+    {
+        const __m256i pt = _mm256_load_si256(reinterpret_cast<const __m256i*>(pieceTo + i));
+        const __m256i ft = _mm256_load_si256(reinterpret_cast<const __m256i*>(fromTo + i));
+
+        __m256i twice = _mm256_add_epi32(gather(mh, ft), gather(ph, pt));
+        twice         = _mm256_add_epi32(twice, gather(ch[0], pt));
+
+        // Division of ch[2] by 4 rounded towards zero, as in C++
+        __m256i quarter = gather(ch[2], pt);
+        quarter         = _mm256_add_epi32(
+          quarter, _mm256_and_si256(_mm256_srai_epi32(quarter, 31), _mm256_set1_epi32(3)));
+        quarter = _mm256_srai_epi32(quarter, 2);
+
+        __m256i sum = _mm256_add_epi32(_mm256_slli_epi32(twice, 1), quarter);
+        sum         = _mm256_add_epi32(sum, gather(ch[1], pt));
+        sum         = _mm256_add_epi32(sum, gather(ch[3], pt));
+        sum         = _mm256_add_epi32(sum, gather(ch[4], pt));
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), sum);
+    }
+#else
+    for (int i = 0; i < n; ++i)
+    {
+        const Piece  pc = pos.moved_piece(begin[i]);
+        const Square to = begin[i].to_sq();
+
+        out[i] = 2 * (*mainHistory)[pos.side_to_move()][begin[i].from_to()]
+               + 2 * (*pawnHistory)[pawn_structure_index(pos)][pc][to]
+               + 2 * (*continuationHistory[0])[pc][to] + (*continuationHistory[1])[pc][to]
+               + (*continuationHistory[2])[pc][to] / 4 + (*continuationHistory[3])[pc][to]
+               + (*continuationHistory[5])[pc][to];
+    }
+#endif
+}
+
 }  // namespace
 
 
@@ -149,8 +230,12 @@ void MovePicker::score() {
 
     [[maybe_unused]] Bitboard threatenedByPawn, threatenedByMinor, threatenedByRook,
       threatenedPieces;
+    [[maybe_unused]] int histories[MAX_MOVES + 8];
     if constexpr (Type == QUIETS)
     {
+        quiet_histories(pos, cur, endMoves, mainHistory, pawnHistory, continuationHistory,
+                        histories);
+
         Color us = pos.side_to_move();
 
         threatenedByPawn = pos.attacks_by<PAWN>(~us);
@@ -178,13 +263,7 @@ void MovePicker::score() {
             Square    to   = m.to_sq();
 
             // histories
-            m.value = 2 * (*mainHistory)[pos.side_to_move()][m.from_to()];
-            m.value += 2 * (*pawnHistory)[pawn_structure_index(pos)][pc][to];
-            m.value += 2 * (*continuationHistory[0])[pc][to];
-            m.value += (*continuationHistory[1])[pc][to];
-            m.value += (*continuationHistory[2])[pc][to] / 4;
-            m.value += (*continuationHistory[3])[pc][to];
-            m.value += (*continuationHistory[5])[pc][to];
+            m.value = histories[&m - cur];
 
             // bonus for checks
             m.value += bool(pos.check_squares(pt) & to) * 16384;
@@ -101,6 +101,36 @@ struct Stats: public std::array<Stats<T, D, Sizes...>, Size> {
 template<typename T, int D, int Size>
 struct Stats<T, D, Size>: public std::array<StatsEntry<T, D>, Size> {};
 
+// A PIECE_DIM dimension is indexed by a Piece, but holds only NO_PIECE and the
+// 12 Makruk pieces instead of PIECE_NB entries, which leaves no unused rows in
+// the tables indexed by two pieces and shrinks the continuation histories of
+// every thread by a third.
+constexpr int PIECE_DIM        = -1;
+constexpr int HISTORY_PIECE_NB = 13;
+
+constexpr int history_index(Piece pc) { return pc - 2 * (pc >> 3); }
+
+static_assert(history_index(B_KING) == HISTORY_PIECE_NB - 1);
+
+template<typename T, int D, int... Sizes>
+struct Stats<T, D, PIECE_DIM, Sizes...>:
+    public std::array<Stats<T, D, Sizes...>, HISTORY_PIECE_NB> {
+    using stats = Stats<T, D, PIECE_DIM, Sizes...>;
+    using base  = std::array<Stats<T, D, Sizes...>, HISTORY_PIECE_NB>;
+
+    auto&       operator[](Piece pc) { return base::operator[](history_index(pc)); }
+    const auto& operator[](Piece pc) const { return base::operator[](history_index(pc)); }
+
+    void fill(const T& v) {
+
+        assert(std::is_standard_layout_v<stats>);
+
+        using entry = StatsEntry<T, D>;
+        entry* p    = reinterpret_cast<entry*>(this);
+        std::fill(p, p + sizeof(*this) / sizeof(entry), v);
+    }
+};
+
 // In stats table, D=0 means that the template parameter is not used
 enum StatsParams {
     NOT_USED = 0
@@ -118,22 +148,22 @@ using ButterflyHistory = Stats<int16_t, 7183, COLOR_NB, int(SQUARE_NB) * int(SQU
 
 // CounterMoveHistory stores counter moves indexed by [piece][to] of the previous
 // move, see www.chessprogramming.org/Countermove_Heuristic
-using CounterMoveHistory = Stats<Move, NOT_USED, PIECE_NB, SQUARE_NB>;
+using CounterMoveHistory = Stats<Move, NOT_USED, PIECE_DIM, SQUARE_NB>;
 
 // CapturePieceToHistory is addressed by a move's [piece][to][captured piece type]
-using CapturePieceToHistory = Stats<int16_t, 10692, PIECE_NB, SQUARE_NB, PIECE_TYPE_NB>;
+using CapturePieceToHistory = Stats<int16_t, 10692, PIECE_DIM, SQUARE_NB, KING + 1>;
 
 // PieceToHistory is like ButterflyHistory but is addressed by a move's [piece][to]
-using PieceToHistory = Stats<int16_t, 29952, PIECE_NB, SQUARE_NB>;
+using PieceToHistory = Stats<int16_t, 29952, PIECE_DIM, SQUARE_NB>;
 
 // ContinuationHistory is the combined history of a given pair of moves, usually
 // the current one given a previous one. The nested history table is based on
 // PieceToHistory instead of ButterflyBoards.
 // (~63 elo)
-using ContinuationHistory = Stats<PieceToHistory, NOT_USED, PIECE_NB, SQUARE_NB>;
+using ContinuationHistory = Stats<PieceToHistory, NOT_USED, PIECE_DIM, SQUARE_NB>;
 
 // PawnHistory is addressed by the pawn structure and a move's [piece][to]
-using PawnHistory = Stats<int16_t, 8192, PAWN_HISTORY_SIZE, PIECE_NB, SQUARE_NB>;
+using PawnHistory = Stats<int16_t, 8192, PAWN_HISTORY_SIZE, PIECE_DIM, SQUARE_NB>;
 
 // CorrectionHistory is addressed by color and pawn structure
 using CorrectionHistory =
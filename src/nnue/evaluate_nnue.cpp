@@ -20,25 +20,30 @@
 
 #include "evaluate_nnue.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstdlib>
 #include <cstring>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <iterator>
 #include <optional>
 #include <sstream>
 #include <string_view>
+#include <thread>
 #include <type_traits>
 #include <unordered_map>
 
 #include "../evaluate.h"
+#include "../memory.h"
 #include "../misc.h"
 #include "../position.h"
 #include "../types.h"
 #include "../uci.h"
 #include "nnue_accumulator.h"
 #include "nnue_common.h"
+#include "nnue_compress.h"
 
 namespace Brainlearn::Eval::NNUE {
 
@@ -60,8 +65,10 @@ namespace Detail {
 template<typename T>
 void initialize(AlignedPtr<T>& pointer) {
 
+    Memory::untrack(pointer.get());
     pointer.reset(reinterpret_cast<T*>(std_aligned_alloc(alignof(T), sizeof(T))));
     std::memset(pointer.get(), 0, sizeof(T));
+    Memory::track(Memory::NETWORKS, pointer.get(), sizeof(T));
 }
 
 template<typename T>
@@ -69,19 +76,21 @@ void initialize(LargePagePtr<T>& pointer) {
 
     static_assert(alignof(T) <= 4096,
                   "aligned_large_pages_alloc() may fail for such a big alignment requirement of T");
+    Memory::untrack(pointer.get());
     pointer.reset(reinterpret_cast<T*>(aligned_large_pages_alloc(sizeof(T))));
     std::memset(pointer.get(), 0, sizeof(T));
+    Memory::track(Memory::NETWORKS, pointer.get(), sizeof(T));
 }
 
 // Read evaluation function parameters
-template<typename T>
-bool read_parameters(std::istream& stream, T& reference) {
+template<typename T, typename... Args>
+bool read_parameters(std::istream& stream, T& reference, Args... args) {
 
     std::uint32_t header;
     header = read_little_endian<std::uint32_t>(stream);
     if (!stream || header != T::get_hash_value())
         return false;
-    return reference.read_parameters(stream);
+    return reference.read_parameters(stream, args...);
 }
 
 // Write evaluation function parameters
@@ -141,11 +150,21 @@ static bool read_parameters(std::istream& stream, NetSize netSize, std::string&
     std::uint32_t hashValue;
     if (!read_header(stream, &hashValue, &netDescription))
         return false;
+
+    // The builds with int8 feature transformer weights read the quantized
+    // networks as they are, and quantize the standard ones.
+    bool quantized = false;
+#ifdef USE_FT_INT8
+    quantized = hashValue == (HashValue[netSize] ^ QuantizedHashFlag);
+    if (quantized)
+        hashValue ^= QuantizedHashFlag;
+#endif
+
     if (hashValue != HashValue[netSize])
         return false;
-    if (netSize == Big && !Detail::read_parameters(stream, *featureTransformerBig))
+    if (netSize == Big && !Detail::read_parameters(stream, *featureTransformerBig, quantized))
         return false;
-    if (netSize == Small && !Detail::read_parameters(stream, *featureTransformerSmall))
+    if (netSize == Small && !Detail::read_parameters(stream, *featureTransformerSmall, quantized))
         return false;
     for (std::size_t i = 0; i < LayerStacks; ++i)
     {
@@ -161,7 +180,13 @@ static bool read_parameters(std::istream& stream, NetSize netSize, std::string&
 static bool
 write_parameters(std::ostream& stream, NetSize netSize, const std::string& netDescription) {
 
-    if (!write_header(stream, HashValue[netSize], netDescription))
+#ifdef USE_FT_INT8
+    const std::uint32_t hashValue = HashValue[netSize] ^ QuantizedHashFlag;
+#else
+    const std::uint32_t hashValue = HashValue[netSize];
+#endif
+
+    if (!write_header(stream, hashValue, netDescription))
         return false;
     if (netSize == Big && !Detail::write_parameters(stream, *featureTransformerBig))
         return false;
@@ -177,13 +202,30 @@ write_parameters(std::ostream& stream, NetSize netSize, const std::string& netDe
     return bool(stream);
 }
 
-void hint_common_parent_position(const Position& pos) {
+void hint_common_parent_position(const Position& pos, bool cascade) {
 
     int simpleEval = simple_eval(pos, pos.side_to_move());
     if (std::abs(simpleEval) > 1050)
         featureTransformerSmall->hint_common_access(pos);
     else
+    {
+        if (cascade)
+            featureTransformerSmall->hint_common_access(pos);
         featureTransformerBig->hint_common_access(pos);
+    }
+}
+
+void prefetch_changed_rows(const Position& pos, bool cascade) {
+
+    int simpleEval = simple_eval(pos, pos.side_to_move());
+    if (std::abs(simpleEval) > 1050)
+        featureTransformerSmall->prefetch_changed_rows(pos);
+    else
+    {
+        if (cascade)
+            featureTransformerSmall->prefetch_changed_rows(pos);
+        featureTransformerBig->prefetch_changed_rows(pos);
+    }
 }
 
 // Evaluation function. Perform differential calculation.
@@ -423,8 +465,8 @@ std::string trace(Position& pos) {
 }
 
 
-// Load eval, from a file stream or a memory stream
-std::optional<std::string> load_eval(std::istream& stream, NetSize netSize) {
+// Read an uncompressed network
+static std::optional<std::string> read_eval(std::istream& stream, NetSize netSize) {
 
     initialize(netSize);
     std::string netDescription;
@@ -432,6 +474,55 @@ std::optional<std::string> load_eval(std::istream& stream, NetSize netSize) {
                                                             : std::nullopt;
 }
 
+// Load eval, from a file stream or a memory stream
+std::optional<std::string> load_eval(std::istream& stream, NetSize netSize) {
+
+    // A compressed network is read whole, to be decompressed in parallel
+    if (stream.peek() == CompressedMagic[0])
+    {
+        const std::string data((std::istreambuf_iterator<char>(stream)),
+                               std::istreambuf_iterator<char>());
+        return load_eval(data.data(), data.size(), netSize);
+    }
+
+    return read_eval(stream, netSize);
+}
+
+// Load eval, from memory that holds a network or a compressed network
+std::optional<std::string> load_eval(const char* data, std::size_t size, NetSize netSize) {
+
+    // C++ way to prepare a buffer for a memory stream
+    class MemoryBuffer: public std::basic_streambuf<char> {
+       public:
+        MemoryBuffer(char* p, size_t n) {
+            setg(p, p, p + n);
+            setp(p, p + n);
+        }
+    };
+
+    const std::size_t rawSize = decompressed_size(data, size);
+
+    if (!rawSize)
+    {
+        MemoryBuffer buffer(const_cast<char*>(data), size);
+        std::istream stream(&buffer);
+        return read_eval(stream, netSize);
+    }
+
+    // The network is decompressed by all the cores into large pages, which take
+    // fewer page faults to fill, and read from there.
+    LargePagePtr<char> raw(static_cast<char*>(aligned_large_pages_alloc(rawSize)));
+
+    if (!raw
+        || !decompress(data, size, raw.get(),
+                       std::max(std::size_t(std::thread::hardware_concurrency()), std::size_t(1))))
+        return std::nullopt;
+
+    MemoryBuffer buffer(raw.get(), rawSize);
+    std::istream stream(&buffer);
+    return read_eval(stream, netSize);
+}
+
 // Save eval, to a file stream or a memory stream
 bool save_eval(std::ostream&      stream,
                NetSize            netSize,
@@ -468,9 +559,24 @@ bool save_eval(const std::optional<std::string>&                              fi
         actualFilename = (netSize == Small ? EvalFileDefaultNameSmall : EvalFileDefaultNameBig);
     }
 
-    std::ofstream stream(actualFilename, std::ios_base::binary);
-    bool          saved = save_eval(stream, netSize, evalFiles.at(netSize).current,
-                                    evalFiles.at(netSize).netDescription);
+    const std::string_view extension = EvalFileCompressedExtension;
+    const bool             compressed =
+      actualFilename.size() > extension.size()
+      && actualFilename.compare(actualFilename.size() - extension.size(), extension.size(),
+                                extension)
+           == 0;
+
+    std::ofstream      stream(actualFilename, std::ios_base::binary);
+    std::ostringstream raw;
+    bool               saved = save_eval(compressed ? static_cast<std::ostream&>(raw) : stream,
+                                         netSize, evalFiles.at(netSize).current,
+                                         evalFiles.at(netSize).netDescription);
+
+    if (saved && compressed)
+    {
+        const std::string data = raw.str();
+        saved                  = compress(data.data(), data.size(), stream);
+    }
 
     msg = saved ? "Network saved successfully to " + actualFilename : "Failed to export a net";
 
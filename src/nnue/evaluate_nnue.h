@@ -21,6 +21,7 @@
 #ifndef NNUE_EVALUATE_NNUE_H_INCLUDED
 #define NNUE_EVALUATE_NNUE_H_INCLUDED
 
+#include <cstddef>
 #include <cstdint>
 #include <iosfwd>
 #include <memory>
@@ -77,9 +78,14 @@ using LargePagePtr = std::unique_ptr<T, LargePageDeleter<T>>;
 std::string trace(Position& pos);
 template<NetSize Net_Size>
 Value evaluate(const Position& pos, bool adjusted = false, int* complexity = nullptr);
-void  hint_common_parent_position(const Position& pos);
+// With the cascaded evaluation both nets may be used below the position, so
+// both accumulators are updated.
+void hint_common_parent_position(const Position& pos, bool cascade = false);
+// Called after a move is made, with the nets the position will be evaluated with
+void prefetch_changed_rows(const Position& pos, bool cascade = false);
 
 std::optional<std::string> load_eval(std::istream& stream, NetSize netSize);
+std::optional<std::string> load_eval(const char* data, std::size_t size, NetSize netSize);
 bool                       save_eval(std::ostream&      stream,
                                      NetSize            netSize,
                                      const std::string& name,
@@ -51,6 +51,9 @@ namespace Brainlearn::Eval::NNUE {
 // Version of the evaluation file
 constexpr std::uint32_t Version = 0x7AF32F20u;
 
+// Xored into the network hash of the files with int8 feature transformer weights
+constexpr std::uint32_t QuantizedHashFlag = 0x5A17E108u;
+
 // Constant used in evaluation value calculation
 constexpr int OutputScale     = 16;
 constexpr int WeightScaleBits = 6;
@@ -165,11 +168,11 @@ inline void write_little_endian(std::ostream& stream, const IntType* values, std
 }
 
 
-// Read N signed integers from the stream s, putting them in the array out.
+// Read N signed integers from the stream s, passing them in order to consume.
 // The stream is assumed to be compressed using the signed LEB128 format.
 // See https://en.wikipedia.org/wiki/LEB128 for a description of the compression scheme.
-template<typename IntType>
-inline void read_leb_128(std::istream& stream, IntType* out, std::size_t count) {
+template<typename IntType, typename Consumer>
+inline void read_leb_128(std::istream& stream, std::size_t count, Consumer consume) {
 
     // Check the presence of our LEB128 magic string
     char leb128MagicString[Leb128MagicStringSize];
@@ -203,9 +206,9 @@ inline void read_leb_128(std::istream& stream, IntType* out, std::size_t count)
 
             if ((byte & 0x80) == 0)
             {
-                out[i] = (sizeof(IntType) * 8 <= shift || (byte & 0x40) == 0)
-                         ? result
-                         : result | ~((1 << shift) - 1);
+                consume(IntType((sizeof(IntType) * 8 <= shift || (byte & 0x40) == 0)
+                                  ? result
+                                  : result | ~((1 << shift) - 1)));
                 break;
             }
         } while (shift < sizeof(IntType) * 8);
@@ -214,6 +217,12 @@ inline void read_leb_128(std::istream& stream, IntType* out, std::size_t count)
     assert(bytes_left == 0);
 }
 
+// Read N signed integers from the stream s, putting them in the array out
+template<typename IntType>
+inline void read_leb_128(std::istream& stream, IntType* out, std::size_t count) {
+    read_leb_128<IntType>(stream, count, [&out](IntType value) { *out++ = value; });
+}
+
 
 // Write signed integers to a stream with LEB128 compression.
 // This takes N integers from array values, compresses them with
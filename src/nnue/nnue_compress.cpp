@@ -0,0 +1,483 @@
+/*
+  Sudsakorn, a UCI makruk playing engine derived from Brainlearn-Stockfish
+  Copyright (C) 2004-2024 The Sudsakorn developers (see AUTHORS file)
+
+  Sudsakorn is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Sudsakorn is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "nnue_compress.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <ostream>
+#include <queue>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// The file layout, with little-endian integers:
+//
+//   magic "NNZ1", chunk size (u32), decompressed size (u64)
+//   for every chunk: compressed size (u32), checksum of the decompressed bytes (u32)
+//   the chunks
+//
+// A chunk starts with its stride: 0 when it is stored as it is, else 1, 2 or 4
+// for the byte planes. Then come the code lengths of the two tables, 4 bits per
+// symbol, and the codes, read from the low bits of each byte.
+
+namespace Brainlearn::Eval::NNUE {
+
+namespace {
+
+constexpr std::size_t HeaderSize = 16;
+constexpr std::size_t ChunkSize  = 1 << 20;
+constexpr int         MaxLength  = 12;  // Of a code, in bits
+constexpr int         Contexts   = 2;
+constexpr std::size_t TablesSize = Contexts * 256 / 2;
+constexpr int         Strides[]  = {1, 2, 4};
+
+std::uint32_t get32(const std::uint8_t* p) {
+    return p[0] | p[1] << 8 | p[2] << 16 | std::uint32_t(p[3]) << 24;
+}
+
+std::uint64_t get64(const std::uint8_t* p) { return get32(p) | std::uint64_t(get32(p + 4)) << 32; }
+
+void put32(std::ostream& out, std::uint32_t v) {
+    for (int i = 0; i < 4; ++i)
+        out.put(char(v >> 8 * i));
+}
+
+// FNV-1a over 64-bit words, to catch a corrupt chunk
+std::uint32_t checksum(const std::uint8_t* p, std::size_t n) {
+
+    std::uint64_t h = 14695981039346656037ULL;
+    std::size_t   i = 0;
+
+    for (; i + 8 <= n; i += 8)
+        h = (h ^ get64(p + i)) * 1099511628211ULL;
+    for (; i < n; ++i)
+        h = (h ^ p[i]) * 1099511628211ULL;
+
+    return std::uint32_t(h ^ (h >> 32));
+}
+
+// Calls f with the offsets of a chunk of n bytes, plane after plane
+template<typename F>
+void for_each_offset(std::size_t n, int stride, F&& f) {
+    for (int k = 0; k < stride; ++k)
+        for (std::size_t i = k; i < n; i += stride)
+            f(i);
+}
+
+// Computes the lengths of a Huffman code for the frequencies. When a code is
+// longer than MaxLength, the frequencies are flattened and it is built again.
+void code_lengths(const std::uint32_t freq[256], std::uint8_t len[256]) {
+
+    std::uint64_t weight[256];
+    int           used = 0, last = 0;
+
+    for (int s = 0; s < 256; ++s)
+    {
+        weight[s] = freq[s];
+        len[s]    = 0;
+        if (freq[s])
+            ++used, last = s;
+    }
+
+    if (used < 2)
+    {
+        len[last] = used;
+        return;
+    }
+
+    while (true)
+    {
+        using Node = std::pair<std::uint64_t, int>;
+        std::priority_queue<Node, std::vector<Node>, std::greater<Node>> queue;
+        int                                                              parent[511];
+        int                                                              next = 256;
+
+        for (int s = 0; s < 256; ++s)
+            if (weight[s])
+                queue.push({weight[s], s});
+
+        while (queue.size() > 1)
+        {
+            const Node a = queue.top();
+            queue.pop();
+            const Node b = queue.top();
+            queue.pop();
+            parent[a.second] = parent[b.second] = next;
+            queue.push({a.first + b.first, next++});
+        }
+
+        int longest = 0;
+        for (int s = 0; s < 256; ++s)
+            if (weight[s])
+            {
+                int depth = 0;
+                for (int n = s; n != next - 1; n = parent[n])
+                    ++depth;
+                len[s]  = std::uint8_t(depth);
+                longest = std::max(longest, depth);
+            }
+
+        if (longest <= MaxLength)
+            return;
+
+        for (int s = 0; s < 256; ++s)
+            if (weight[s])
+                weight[s] = (weight[s] >> 1) | 1;
+    }
+}
+
+// Assigns the canonical codes of the lengths, bit reversed because the codes
+// are read from the low bits. Returns false if the lengths are not a prefix code.
+bool canonical_codes(const std::uint8_t len[256], std::uint16_t code[256]) {
+
+    int count[MaxLength + 1] = {}, next[MaxLength + 1] = {};
+    int space = 1 << MaxLength;
+
+    for (int s = 0; s < 256; ++s)
+        if (len[s])
+        {
+            ++count[len[s]];
+            space -= 1 << (MaxLength - len[s]);
+        }
+
+    for (int l = 1, c = 0; l <= MaxLength; ++l)
+        next[l] = c = (c + count[l - 1]) << 1;
+
+    for (int s = 0; s < 256; ++s)
+        if (len[s])
+        {
+            int c = next[len[s]]++, r = 0;
+            for (int b = 0; b < len[s]; ++b)
+                r |= ((c >> b) & 1) << (len[s] - 1 - b);
+            code[s] = std::uint16_t(r);
+        }
+
+    return space >= 0;
+}
+
+std::vector<std::uint8_t> compress_chunk(const std::uint8_t* p, std::size_t n) {
+
+    std::uint32_t freq[Strides[2] + 1][Contexts][256] = {};
+    std::uint8_t  len[Contexts][256];
+    std::size_t   bestSize = n, bestBits = 0;
+    int           bestStride = 0;
+
+    // Picks the stride that gives the shortest codes
+    for (int stride : Strides)
+    {
+        int ctx = 0;
+        for_each_offset(n, stride, [&](std::size_t i) {
+            ++freq[stride][ctx][p[i]];
+            ctx = p[i] >> 7;
+        });
+
+        std::size_t bits = 0;
+        for (int c = 0; c < Contexts; ++c)
+        {
+            code_lengths(freq[stride][c], len[c]);
+            for (int s = 0; s < 256; ++s)
+                bits += std::size_t(freq[stride][c][s]) * len[c][s];
+        }
+
+        if (TablesSize + (bits + 7) / 8 < bestSize)
+            bestSize = TablesSize + (bits + 7) / 8, bestBits = bits, bestStride = stride;
+    }
+
+    std::vector<std::uint8_t> out{std::uint8_t(bestStride)};
+
+    if (!bestStride)
+    {
+        out.resize(1 + n);
+        std::memcpy(out.data() + 1, p, n);
+        return out;
+    }
+
+    std::uint16_t code[Contexts][256];
+    for (int c = 0; c < Contexts; ++c)
+    {
+        code_lengths(freq[bestStride][c], len[c]);
+        canonical_codes(len[c], code[c]);
+        for (int s = 0; s < 256; s += 2)
+            out.push_back(std::uint8_t(len[c][s] | len[c][s + 1] << 4));
+    }
+
+    out.reserve(out.size() + (bestBits + 7) / 8);
+
+    std::uint64_t acc   = 0;
+    int           count = 0, ctx = 0;
+
+    for_each_offset(n, bestStride, [&](std::size_t i) {
+        acc |= std::uint64_t(code[ctx][p[i]]) << count;
+        count += len[ctx][p[i]];
+        ctx = p[i] >> 7;
+
+        for (; count >= 8; count -= 8, acc >>= 8)
+            out.push_back(std::uint8_t(acc));
+    });
+
+    if (count)
+        out.push_back(std::uint8_t(acc));
+
+    return out;
+}
+
+bool decompress_chunk(const std::uint8_t* p, std::size_t size, std::uint8_t* out, std::size_t n) {
+
+    if (!size)
+        return false;
+
+    const int stride = p[0];
+
+    if (!stride)
+    {
+        if (size != n + 1)
+            return false;
+
+        std::memcpy(out, p + 1, n);
+        return true;
+    }
+
+    if (std::find(std::begin(Strides), std::end(Strides), stride) == std::end(Strides)
+        || size < 1 + TablesSize)
+        return false;
+
+    // The decoding tables give the symbol and the length of the code found in
+    // the next MaxLength bits. A zero length marks a corrupt stream.
+    std::uint16_t table[Contexts][1 << MaxLength] = {};
+
+    for (int c = 0; c < Contexts; ++c)
+    {
+        std::uint8_t  len[256];
+        std::uint16_t code[256];
+
+        for (int s = 0; s < 256; ++s)
+        {
+            len[s] = (p[1 + c * 128 + s / 2] >> (s & 1) * 4) & 15;
+            if (len[s] > MaxLength)
+                return false;
+        }
+
+        if (!canonical_codes(len, code))
+            return false;
+
+        for (int s = 0; s < 256; ++s)
+            if (len[s])
+                for (int i = code[s]; i < 1 << MaxLength; i += 1 << len[s])
+                    table[c][i] = std::uint16_t(s << 4 | len[s]);
+    }
+
+    const std::uint8_t *in = p + 1 + TablesSize, *const end = p + size;
+    std::uint64_t       bits  = 0;
+    std::size_t         pad   = 0;  // Zero bytes read past the end
+    int                 count = 0, ctx = 0, bad = 0;
+
+    auto refill = [&]() {
+        if (end - in >= 8)
+        {
+            bits |= get64(in) << count;
+            in += (63 - count) >> 3;
+            count |= 56;
+        }
+        else
+            for (; count <= 56; count += 8)
+                if (in < end)
+                    bits |= std::uint64_t(*in++) << count;
+                else
+                    ++pad;
+    };
+
+    auto decode = [&](std::size_t i) {
+        const int entry = table[ctx][bits & ((1 << MaxLength) - 1)];
+        const int l     = entry & 15;
+
+        bad |= l == 0;
+        bits >>= l;
+        count -= l;
+        out[i] = std::uint8_t(entry >> 4);
+        ctx    = entry >> 11;
+    };
+
+    // A refill leaves at least 56 bits, enough for 4 codes
+    for (int k = 0; k < stride; ++k)
+    {
+        std::size_t i = k;
+
+        for (; i + 3 * stride < n; i += 4 * stride)
+        {
+            refill();
+            decode(i);
+            decode(i + stride);
+            decode(i + 2 * stride);
+            decode(i + 3 * stride);
+        }
+
+        for (; i < n; i += stride)
+        {
+            refill();
+            decode(i);
+        }
+    }
+
+    // The codes must not run past the end
+    return !bad && pad * 8 <= std::size_t(count);
+}
+
+}  // namespace
+
+
+std::size_t decompressed_size(const char* data, std::size_t size) {
+
+    const auto* p = reinterpret_cast<const std::uint8_t*>(data);
+
+    if (size < HeaderSize || std::memcmp(data, CompressedMagic, sizeof(CompressedMagic)))
+        return 0;
+
+    return std::size_t(get64(p + 8));
+}
+
+bool decompress(const char* data, std::size_t size, char* out, std::size_t threadCount) {
+
+    const auto*       p         = reinterpret_cast<const std::uint8_t*>(data);
+    const std::size_t rawSize   = decompressed_size(data, size);
+    const std::size_t chunkSize = rawSize ? get32(p + 4) : 0;
+
+    if (!chunkSize)
+        return false;
+
+    const std::size_t chunkCount = (rawSize - 1) / chunkSize + 1;
+
+    if ((size - HeaderSize) / 8 < chunkCount)
+        return false;
+
+    std::vector<std::size_t> offsets{HeaderSize + 8 * chunkCount};
+
+    for (std::size_t i = 0; i < chunkCount; ++i)
+        offsets.push_back(offsets.back() + get32(p + HeaderSize + 8 * i));
+
+    if (offsets.back() > size)
+        return false;
+
+    std::atomic<std::size_t> next{0};
+    std::atomic<bool>        ok{true};
+
+    auto work = [&]() {
+        for (std::size_t i; ok && (i = next++) < chunkCount;)
+        {
+            auto* const       chunk = reinterpret_cast<std::uint8_t*>(out) + i * chunkSize;
+            const std::size_t n     = std::min(chunkSize, rawSize - i * chunkSize);
+
+            if (!decompress_chunk(p + offsets[i], offsets[i + 1] - offsets[i], chunk, n)
+                || checksum(chunk, n) != get32(p + HeaderSize + 8 * i + 4))
+                ok = false;
+        }
+    };
+
+    std::vector<std::thread> threads;
+
+    for (std::size_t t = 1; t < std::min(threadCount, chunkCount); ++t)
+        threads.emplace_back(work);
+
+    work();
+
+    for (std::thread& th : threads)
+        th.join();
+
+    return ok;
+}
+
+bool compress(const char* data, std::size_t size, std::ostream& out) {
+
+    const auto*                            p = reinterpret_cast<const std::uint8_t*>(data);
+    std::vector<std::vector<std::uint8_t>> chunks;
+
+    out.write(CompressedMagic, sizeof(CompressedMagic));
+    put32(out, ChunkSize);
+    put32(out, std::uint32_t(size));
+    put32(out, std::uint32_t(std::uint64_t(size) >> 32));
+
+    for (std::size_t i = 0; i < size; i += ChunkSize)
+    {
+        const std::size_t n = std::min(ChunkSize, size - i);
+
+        chunks.push_back(compress_chunk(p + i, n));
+        put32(out, std::uint32_t(chunks.back().size()));
+        put32(out, checksum(p + i, n));
+    }
+
+    for (const auto& chunk : chunks)
+        out.write(reinterpret_cast<const char*>(chunk.data()), std::streamsize(chunk.size()));
+
+    return bool(out);
+}
+
+}  // namespace Brainlearn::Eval::NNUE
+
+
+// The codec is also built on its own by "make net netcompress=yes", to compress
+// the networks that are embedded: nnzip <network> <compressed network>
+#if defined(NNUE_COMPRESS_TOOL)
+
+int main(int argc, char* argv[]) {
+
+    if (argc != 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " <network> <compressed network>" << std::endl;
+        return 1;
+    }
+
+    std::ifstream      in(argv[1], std::ios::binary);
+    const std::string  data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    std::ofstream      out(argv[2], std::ios::binary);
+    std::vector<char>  check(data.size());
+    const std::size_t  threads = std::max(1u, std::thread::hardware_concurrency());
+
+    if (!in || data.empty() || !Brainlearn::Eval::NNUE::compress(data.data(), data.size(), out)
+        || !out.flush())
+    {
+        std::cerr << "Failed to compress " << argv[1] << " to " << argv[2] << std::endl;
+        return 1;
+    }
+
+    out.close();
+
+    // Reads the file back, so that a broken codec never gets embedded
+    std::ifstream     back(argv[2], std::ios::binary);
+    const std::string packed((std::istreambuf_iterator<char>(back)),
+                             std::istreambuf_iterator<char>());
+
+    if (Brainlearn::Eval::NNUE::decompressed_size(packed.data(), packed.size()) != data.size()
+        || !Brainlearn::Eval::NNUE::decompress(packed.data(), packed.size(), check.data(), threads)
+        || std::memcmp(check.data(), data.data(), data.size()))
+    {
+        std::cerr << "Failed to decompress " << argv[2] << std::endl;
+        return 1;
+    }
+
+    std::cout << argv[2] << ": " << data.size() << " -> " << packed.size() << " bytes"
+              << std::endl;
+    return 0;
+}
+
+#endif
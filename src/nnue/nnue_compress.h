@@ -0,0 +1,53 @@
+/*
+  Sudsakorn, a UCI makruk playing engine derived from Brainlearn-Stockfish
+  Copyright (C) 2004-2024 The Sudsakorn developers (see AUTHORS file)
+
+  Sudsakorn is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Sudsakorn is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Codec of the compressed network files (.nnz), used to embed the networks
+// compressed in the binary.
+//
+// The file is cut into chunks of 1 MiB that are compressed on their own, so that
+// they can be decompressed in parallel. A chunk is first optionally split into
+// byte planes: the bytes at every 2nd or 4th offset are grouped, which separates
+// the low and high bytes of the raw int16 and int32 parameters. It is then
+// Huffman coded with two tables, picked by the top bit of the previous byte. In
+// the LEB128 streams of the feature transformer this bit tells the first byte
+// of a weight from its continuation bytes, which have very different statistics.
+
+#ifndef NNUE_COMPRESS_H_INCLUDED
+#define NNUE_COMPRESS_H_INCLUDED
+
+#include <cstddef>
+#include <iosfwd>
+
+namespace Brainlearn::Eval::NNUE {
+
+// First bytes of a compressed network. They cannot start an uncompressed one.
+constexpr char CompressedMagic[4] = {'N', 'N', 'Z', '1'};
+
+// Returns the size of the network compressed in data, or 0 if data does not
+// hold a compressed network
+std::size_t decompressed_size(const char* data, std::size_t size);
+
+// Decompresses data into out, which must hold decompressed_size() bytes, with up
+// to threadCount threads. Returns false if the data is corrupt.
+bool decompress(const char* data, std::size_t size, char* out, std::size_t threadCount);
+
+bool compress(const char* data, std::size_t size, std::ostream& out);
+
+}  // namespace Brainlearn::Eval::NNUE
+
+#endif  // #ifndef NNUE_COMPRESS_H_INCLUDED
@@ -24,6 +24,7 @@
 #include <algorithm>
 #include <cassert>
 #include <cstdint>
+#include <cstdlib>
 #include <cstring>
 #include <iosfwd>
 #include <utility>
@@ -36,10 +37,21 @@
 
 namespace Brainlearn::Eval::NNUE {
 
-using BiasType       = std::int16_t;
-using WeightType     = std::int16_t;
+using BiasType = std::int16_t;
+#ifdef USE_FT_INT8
+using WeightType = std::int8_t;
+using ScaleType  = std::int16_t;
+#else
+using WeightType = std::int16_t;
+#endif
 using PSQTWeightType = std::int32_t;
 
+#ifdef USE_FT_INT8
+// The int8 weights of a feature are multiplied by one scale per block of
+// consecutive outputs, which halves the memory read by the accumulator updates.
+constexpr IndexType WeightBlockSize = 64;
+#endif
+
 // If vector instructions are enabled, we update and refresh the
 // accumulator tile by tile such that each tile fits in the CPU's
 // vector registers.
@@ -53,6 +65,7 @@ using vec_t      = __m512i;
 using psqt_vec_t = __m256i;
     #define vec_load(a) _mm512_load_si512(a)
     #define vec_store(a, b) _mm512_store_si512(a, b)
+    #define vec_load_8_16(a) _mm512_cvtepi8_epi16(_mm256_load_si256((const __m256i*) (a)))
     #define vec_add_16(a, b) _mm512_add_epi16(a, b)
     #define vec_sub_16(a, b) _mm512_sub_epi16(a, b)
     #define vec_mul_16(a, b) _mm512_mullo_epi16(a, b)
@@ -77,6 +90,7 @@ using vec_t      = __m256i;
 using psqt_vec_t = __m256i;
     #define vec_load(a) _mm256_load_si256(a)
     #define vec_store(a, b) _mm256_store_si256(a, b)
+    #define vec_load_8_16(a) _mm256_cvtepi8_epi16(_mm_load_si128((const __m128i*) (a)))
     #define vec_add_16(a, b) _mm256_add_epi16(a, b)
     #define vec_sub_16(a, b) _mm256_sub_epi16(a, b)
     #define vec_mul_16(a, b) _mm256_mullo_epi16(a, b)
@@ -101,6 +115,10 @@ using vec_t      = __m128i;
 using psqt_vec_t = __m128i;
     #define vec_load(a) (*(a))
     #define vec_store(a, b) *(a) = (b)
+inline vec_t vec_load_8_16(const std::int8_t* a) {
+    const vec_t b = _mm_loadl_epi64((const __m128i*) a);
+    return _mm_srai_epi16(_mm_unpacklo_epi8(b, b), 8);
+}
     #define vec_add_16(a, b) _mm_add_epi16(a, b)
     #define vec_sub_16(a, b) _mm_sub_epi16(a, b)
     #define vec_mul_16(a, b) _mm_mullo_epi16(a, b)
@@ -122,6 +140,7 @@ using vec_t      = int16x8_t;
 using psqt_vec_t = int32x4_t;
     #define vec_load(a) (*(a))
     #define vec_store(a, b) *(a) = (b)
+    #define vec_load_8_16(a) vmovl_s8(vld1_s8(a))
     #define vec_add_16(a, b) vaddq_s16(a, b)
     #define vec_sub_16(a, b) vsubq_s16(a, b)
     #define vec_mul_16(a, b) vmulq_s16(a, b)
@@ -203,7 +222,7 @@ class FeatureTransformer {
 
 #ifdef VECTOR
     static constexpr int NumRegs =
-      BestRegisterCount<vec_t, WeightType, TransformedFeatureDimensions, NumRegistersSIMD>();
+      BestRegisterCount<vec_t, BiasType, TransformedFeatureDimensions, NumRegistersSIMD>();
     static constexpr int NumPsqtRegs =
       BestRegisterCount<psqt_vec_t, PSQTWeightType, PSQTBuckets, NumRegistersSIMD>();
 
@@ -211,6 +230,14 @@ class FeatureTransformer {
     static constexpr IndexType PsqtTileHeight = NumPsqtRegs * sizeof(psqt_vec_t) / 4;
     static_assert(HalfDimensions % TileHeight == 0, "TileHeight must divide HalfDimensions");
     static_assert(PSQTBuckets % PsqtTileHeight == 0, "PsqtTileHeight must divide PSQTBuckets");
+    #ifdef USE_FT_INT8
+    static_assert(WeightBlockSize % (sizeof(vec_t) / 2) == 0, "A vector must not cross blocks");
+    #endif
+#endif
+
+#ifdef USE_FT_INT8
+    static constexpr IndexType BlocksPerFeature = HalfDimensions / WeightBlockSize;
+    static_assert(HalfDimensions % WeightBlockSize == 0);
 #endif
 
    public:
@@ -229,11 +256,37 @@ class FeatureTransformer {
         return FeatureSet::HashValue ^ (OutputDimensions * 2);
     }
 
-    // Read network parameters
-    bool read_parameters(std::istream& stream) {
+    // Read network parameters. The weights are int8 with their scales in the
+    // quantized files, and int16 otherwise.
+    bool read_parameters(std::istream& stream, [[maybe_unused]] bool quantized = false) {
 
         read_leb_128<BiasType>(stream, biases, HalfDimensions);
+#ifdef USE_FT_INT8
+        if (quantized)
+        {
+            read_leb_128<WeightType>(stream, weights, HalfDimensions * InputDimensions);
+            read_leb_128<ScaleType>(stream, scales, BlocksPerFeature * InputDimensions);
+        }
+        else
+        {
+            // Quantize the int16 weights one feature at a time, as they are read
+            std::int16_t row[HalfDimensions];
+            IndexType    j = 0, index = 0;
+
+            read_leb_128<std::int16_t>(stream, HalfDimensions * InputDimensions,
+                                       [&](std::int16_t w) {
+                                           row[j++] = w;
+                                           if (j == HalfDimensions)
+                                           {
+                                               quantize(index++, row);
+                                               j = 0;
+                                           }
+                                       });
+        }
+#else
+        assert(!quantized);
         read_leb_128<WeightType>(stream, weights, HalfDimensions * InputDimensions);
+#endif
         read_leb_128<PSQTWeightType>(stream, psqtWeights, PSQTBuckets * InputDimensions);
 
         return !stream.fail();
@@ -244,6 +297,9 @@ class FeatureTransformer {
 
         write_leb_128<BiasType>(stream, biases, HalfDimensions);
         write_leb_128<WeightType>(stream, weights, HalfDimensions * InputDimensions);
+#ifdef USE_FT_INT8
+        write_leb_128<ScaleType>(stream, scales, BlocksPerFeature * InputDimensions);
+#endif
         write_leb_128<PSQTWeightType>(stream, psqtWeights, PSQTBuckets * InputDimensions);
 
         return !stream.fail();
@@ -317,7 +373,63 @@ class FeatureTransformer {
         hint_common_access_for_perspective<BLACK>(pos);
     }
 
+    // Prefetches the weights of the features changed by the last move, which
+    // the incremental update reads when the position is evaluated
+    void prefetch_changed_rows(const Position& pos) const {
+        prefetch_changed_rows_for_perspective<WHITE>(pos);
+        prefetch_changed_rows_for_perspective<BLACK>(pos);
+    }
+
    private:
+#ifdef USE_FT_INT8
+    // Quantizes the int16 weights of a feature with, for each block, the
+    // smallest scale that fits them in int8. Blocks within int8 stay exact.
+    void quantize(IndexType index, const std::int16_t* row) {
+
+        for (IndexType b = 0; b < BlocksPerFeature; ++b)
+        {
+            const std::int16_t* w      = row + b * WeightBlockSize;
+            int                 maxAbs = 0;
+
+            for (IndexType j = 0; j < WeightBlockSize; ++j)
+                maxAbs = std::max(maxAbs, std::abs(int(w[j])));
+
+            const int scale = std::max(1, (maxAbs + 126) / 127);
+            scales[BlocksPerFeature * index + b] = ScaleType(scale);
+
+            for (IndexType j = 0; j < WeightBlockSize; ++j)
+            {
+                const int q = (2 * w[j] + (w[j] < 0 ? -scale : scale)) / (2 * scale);
+                weights[HalfDimensions * index + b * WeightBlockSize + j] =
+                  WeightType(std::clamp(q, -32767 / scale, 32767 / scale));
+            }
+        }
+    }
+#endif
+
+    // The weight of a feature for one output
+    BiasType weight(IndexType index, IndexType j) const {
+#ifdef USE_FT_INT8
+        return BiasType(weights[HalfDimensions * index + j]
+                        * scales[BlocksPerFeature * index + j / WeightBlockSize]);
+#else
+        return weights[HalfDimensions * index + j];
+#endif
+    }
+
+#ifdef VECTOR
+    // The k-th vector of the weights of a feature
+    vec_t weight_vec(IndexType index, IndexType k) const {
+    #ifdef USE_FT_INT8
+        const IndexType j = k * (sizeof(vec_t) / 2);
+        return vec_mul_16(vec_load_8_16(&weights[HalfDimensions * index + j]),
+                          vec_set_16(scales[BlocksPerFeature * index + j / WeightBlockSize]));
+    #else
+        return reinterpret_cast<const vec_t*>(&weights[HalfDimensions * index])[k];
+    #endif
+    }
+#endif
+
     template<Color Perspective>
     [[nodiscard]] std::pair<StateInfo*, StateInfo*>
     try_find_computed_accumulator(const Position& pos) const {
@@ -408,26 +520,25 @@ class FeatureTransformer {
             auto accOut = reinterpret_cast<vec_t*>(
               &(states_to_update[0]->*accPtr).accumulation[Perspective][0]);
 
-            const IndexType offsetR0 = HalfDimensions * removed[0][0];
-            auto            columnR0 = reinterpret_cast<const vec_t*>(&weights[offsetR0]);
-            const IndexType offsetA  = HalfDimensions * added[0][0];
-            auto            columnA  = reinterpret_cast<const vec_t*>(&weights[offsetA]);
+            const IndexType indexR0 = removed[0][0];
+            const IndexType indexA  = added[0][0];
 
             if (removed[0].size() == 1)
             {
                 for (IndexType k = 0; k < HalfDimensions * sizeof(std::int16_t) / sizeof(vec_t);
                      ++k)
-                    accOut[k] = vec_add_16(vec_sub_16(accIn[k], columnR0[k]), columnA[k]);
+                    accOut[k] = vec_add_16(vec_sub_16(accIn[k], weight_vec(indexR0, k)),
+                                           weight_vec(indexA, k));
             }
             else
             {
-                const IndexType offsetR1 = HalfDimensions * removed[0][1];
-                auto            columnR1 = reinterpret_cast<const vec_t*>(&weights[offsetR1]);
+                const IndexType indexR1 = removed[0][1];
 
                 for (IndexType k = 0; k < HalfDimensions * sizeof(std::int16_t) / sizeof(vec_t);
                      ++k)
-                    accOut[k] = vec_sub_16(vec_add_16(accIn[k], columnA[k]),
-                                           vec_add_16(columnR0[k], columnR1[k]));
+                    accOut[k] =
+                      vec_sub_16(vec_add_16(accIn[k], weight_vec(indexA, k)),
+                                 vec_add_16(weight_vec(indexR0, k), weight_vec(indexR1, k)));
             }
 
             auto accPsqtIn =
@@ -473,21 +584,13 @@ class FeatureTransformer {
                 {
                     // Difference calculation for the deactivated features
                     for (const auto index : removed[i])
-                    {
-                        const IndexType offset = HalfDimensions * index + j * TileHeight;
-                        auto            column = reinterpret_cast<const vec_t*>(&weights[offset]);
                         for (IndexType k = 0; k < NumRegs; ++k)
-                            acc[k] = vec_sub_16(acc[k], column[k]);
-                    }
+                            acc[k] = vec_sub_16(acc[k], weight_vec(index, j * NumRegs + k));
 
                     // Difference calculation for the activated features
                     for (const auto index : added[i])
-                    {
-                        const IndexType offset = HalfDimensions * index + j * TileHeight;
-                        auto            column = reinterpret_cast<const vec_t*>(&weights[offset]);
                         for (IndexType k = 0; k < NumRegs; ++k)
-                            acc[k] = vec_add_16(acc[k], column[k]);
-                    }
+                            acc[k] = vec_add_16(acc[k], weight_vec(index, j * NumRegs + k));
 
                     // Store accumulator
                     auto accTileOut = reinterpret_cast<vec_t*>(
@@ -549,10 +652,8 @@ class FeatureTransformer {
             // Difference calculation for the deactivated features
             for (const auto index : removed[i])
             {
-                const IndexType offset = HalfDimensions * index;
-
                 for (IndexType j = 0; j < HalfDimensions; ++j)
-                    (st->*accPtr).accumulation[Perspective][j] -= weights[offset + j];
+                    (st->*accPtr).accumulation[Perspective][j] -= weight(index, j);
 
                 for (std::size_t k = 0; k < PSQTBuckets; ++k)
                     (st->*accPtr).psqtAccumulation[Perspective][k] -=
@@ -562,10 +663,8 @@ class FeatureTransformer {
             // Difference calculation for the activated features
             for (const auto index : added[i])
             {
-                const IndexType offset = HalfDimensions * index;
-
                 for (IndexType j = 0; j < HalfDimensions; ++j)
-                    (st->*accPtr).accumulation[Perspective][j] += weights[offset + j];
+                    (st->*accPtr).accumulation[Perspective][j] += weight(index, j);
 
                 for (std::size_t k = 0; k < PSQTBuckets; ++k)
                     (st->*accPtr).psqtAccumulation[Perspective][k] +=
@@ -600,13 +699,8 @@ class FeatureTransformer {
                 acc[k] = biasesTile[k];
 
             for (const auto index : active)
-            {
-                const IndexType offset = HalfDimensions * index + j * TileHeight;
-                auto            column = reinterpret_cast<const vec_t*>(&weights[offset]);
-
                 for (unsigned k = 0; k < NumRegs; ++k)
-                    acc[k] = vec_add_16(acc[k], column[k]);
-            }
+                    acc[k] = vec_add_16(acc[k], weight_vec(index, j * NumRegs + k));
 
             auto accTile =
               reinterpret_cast<vec_t*>(&accumulator.accumulation[Perspective][j * TileHeight]);
@@ -643,10 +737,8 @@ class FeatureTransformer {
 
         for (const auto index : active)
         {
-            const IndexType offset = HalfDimensions * index;
-
             for (IndexType j = 0; j < HalfDimensions; ++j)
-                accumulator.accumulation[Perspective][j] += weights[offset + j];
+                accumulator.accumulation[Perspective][j] += weight(index, j);
 
             for (std::size_t k = 0; k < PSQTBuckets; ++k)
                 accumulator.psqtAccumulation[Perspective][k] +=
@@ -679,6 +771,40 @@ class FeatureTransformer {
             update_accumulator_refresh<Perspective>(pos);
     }
 
+    template<Color Perspective>
+    void prefetch_changed_rows_for_perspective(const Position& pos) const {
+
+        // The accumulator is refreshed after a king move
+        if (FeatureSet::requires_refresh(pos.state(), Perspective))
+            return;
+
+        FeatureSet::IndexList removed, added;
+        FeatureSet::append_changed_indices<Perspective>(
+          pos.square<KING>(Perspective), pos.state()->dirtyPiece, removed, added);
+
+        for (const auto index : removed)
+            prefetch_row(index);
+        for (const auto index : added)
+            prefetch_row(index);
+    }
+
+    // Only the first lines of a row are requested, the hardware prefetcher
+    // follows with the rest of it as the update streams through the row.
+    void prefetch_row(IndexType index) const {
+
+        constexpr std::size_t PrefetchSize =
+          std::min<std::size_t>(HalfDimensions * sizeof(WeightType), 4 * CacheLineSize);
+
+        auto row = reinterpret_cast<const char*>(&weights[HalfDimensions * index]);
+        for (std::size_t i = 0; i < PrefetchSize; i += CacheLineSize)
+            prefetch(const_cast<char*>(row + i));
+
+        prefetch(const_cast<PSQTWeightType*>(&psqtWeights[PSQTBuckets * index]));
+#ifdef USE_FT_INT8
+        prefetch(const_cast<ScaleType*>(&scales[BlocksPerFeature * index]));
+#endif
+    }
+
     template<Color Perspective>
     void update_accumulator(const Position& pos) const {
 
@@ -707,6 +833,9 @@ class FeatureTransformer {
 
     alignas(CacheLineSize) BiasType biases[HalfDimensions];
     alignas(CacheLineSize) WeightType weights[HalfDimensions * InputDimensions];
+#ifdef USE_FT_INT8
+    alignas(CacheLineSize) ScaleType scales[BlocksPerFeature * InputDimensions];
+#endif
     alignas(CacheLineSize) PSQTWeightType psqtWeights[InputDimensions * PSQTBuckets];
 };
 
@@ -19,11 +19,14 @@
 #ifndef POSITION_H_INCLUDED
 #define POSITION_H_INCLUDED
 
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
 #include <deque>
 #include <iosfwd>
 #include <memory>
 #include <string>
+#include <string_view>
 
 #include "bitboard.h"
 #include "nnue/nnue_accumulator.h"
@@ -37,6 +40,23 @@ extern void putGameLineIntoLearningTable();
 //Kelly end
 class TranspositionTable;
 
+// Piece letters of the FEN strings, indexed by piece. Makruk pieces map to the
+// chess piece types by their letters: met (M) is KNIGHT, khon (S) is BISHOP,
+// ma (N) is ROOK and ruea (R) is QUEEN.
+constexpr std::string_view PieceToChar(" PMSNRK  pmsnrk");
+
+// Returns the number of moves the pieces' honor counting allows when the side
+// with the pieces has count[pt] pieces of every type pt, before subtracting the
+// number of pieces on the board.
+constexpr int pieces_honor_limit(const int count[PIECE_TYPE_NB]) {
+    return count[QUEEN] >= 2  ? 8
+         : count[QUEEN] == 1  ? 16
+         : count[BISHOP] >= 2 ? 22
+         : count[ROOK] >= 2   ? 32
+         : count[BISHOP] == 1 ? 44
+                              : 64;
+}
+
 // StateInfo struct stores information needed to restore a Position object to
 // its previous state when we retract a move. Whenever a move is made on the
 // board (by calling Position::do_move), a StateInfo object must be passed.
@@ -49,6 +69,8 @@ struct StateInfo {
     Value  nonPawnMaterial[COLOR_NB];
     int    rule50;
     int    pliesFromNull;
+    int    countingPly;    // Plies played since the current Makruk count started
+    int    countingLimit;  // Plies allowed by the current count, 0 if none applies
 
     // Not copied when making a move (will be recomputed anyhow)
     Key        key;
@@ -80,7 +102,6 @@ using StateListPtr = std::unique_ptr<std::deque<StateInfo>>;
 // traversing the search tree.
 class Position {
    public:
-    static void init();
 
     Position()                           = default;
     Position(const Position&)            = delete;
@@ -119,6 +140,8 @@ class Position {
     void     update_slider_blockers(Color c) const;
     template<PieceType Pt>
     Bitboard attacks_by(Color c) const;
+    Bitboard leaper_attacks(Color c) const;
+    bool     attacked_by(Color c, Square s, Bitboard occupied) const;
 
     // Properties of moves
     bool  legal(Move m) const;
@@ -153,6 +176,9 @@ class Position {
     bool  has_game_cycle(int ply) const;
     bool  has_repeated() const;
     int   rule50_count() const;
+    int   counting_ply() const;
+    int   counting_limit() const;
+    int   draw_horizon() const;
     Value non_pawn_material(Color c) const;
     Value non_pawn_material() const;
 
@@ -173,8 +199,11 @@ class Position {
 
     // Other helpers
     void move_piece(Square from, Square to);
+    template<bool Add>
+    void update_attacks(Piece pc, Square s);
+    int  counting_rule_limit() const;
     template<bool AfterMove>
-    Key adjust_key50(Key k) const;
+    Key adjust_key(Key k) const;
 
     // Data members
     Piece      board[SQUARE_NB];
@@ -185,6 +214,11 @@ class Position {
     int        gamePly;
     Color      sideToMove;
     bool       chess960;
+
+#if defined(USE_ATTACK_MAPS)
+    uint8_t  attackCount[COLOR_NB][SQUARE_NB];
+    Bitboard attackedBy[COLOR_NB];  // The squares with a non-zero count
+#endif
 };
 
 std::ostream& operator<<(std::ostream& os, const Position& pos);
@@ -248,6 +282,29 @@ inline Bitboard Position::attacks_by(Color c) const {
     }
 }
 
+// Returns the squares attacked by the pieces of color c that attackers_to()
+// does not treat as sliders: pawns, knights, bishops and the king.
+inline Bitboard Position::leaper_attacks(Color c) const {
+
+#if defined(USE_ATTACK_MAPS)
+    return attackedBy[c];
+#else
+    return attacks_by<PAWN>(c) | attacks_by<KNIGHT>(c) | attacks_by<BISHOP>(c)
+         | attacks_by<KING>(c);
+#endif
+}
+
+// Tests whether a piece of color c attacks square s. The occupancy is only
+// used for the sliders, so the leapers of color c must all stand on it.
+inline bool Position::attacked_by(Color c, Square s, Bitboard occupied) const {
+
+#if defined(USE_ATTACK_MAPS)
+    return attackCount[c][s] || (attacks_bb<ROOK>(s, occupied) & pieces(c, ROOK, QUEEN));
+#else
+    return attackers_to(s, occupied) & pieces(c);
+#endif
+}
+
 inline Bitboard Position::checkers() const { return st->checkersBB; }
 
 inline Bitboard Position::blockers_for_king(Color c) const { return st->blockersForKing[c]; }
@@ -256,11 +313,14 @@ inline Bitboard Position::pinners(Color c) const { return st->pinners[c]; }
 
 inline Bitboard Position::check_squares(PieceType pt) const { return st->checkSquares[pt]; }
 
-inline Key Position::key() const { return adjust_key50<false>(st->key); }
+inline Key Position::key() const { return adjust_key<false>(st->key); }
 
+// Folds the distance to the nearest draw by rule into the key once the draw
+// gets close, so that TT entries from far and near the horizon do not mix.
 template<bool AfterMove>
-inline Key Position::adjust_key50(Key k) const {
-    return st->rule50 < 14 - AfterMove ? k : k ^ make_key((st->rule50 - (14 - AfterMove)) / 8);
+inline Key Position::adjust_key(Key k) const {
+    const int left = draw_horizon() - AfterMove;
+    return left > 86 ? k : k ^ make_key((86 - left) / 8);
 }
 
 inline Key Position::pawn_key() const { return st->pawnKey; }
@@ -277,7 +337,18 @@ inline int Position::game_ply() const { return gamePly; }
 
 inline int Position::rule50_count() const { return st->rule50; }
 
-inline bool Position::is_chess960() const { return chess960; }
+inline int Position::counting_ply() const { return st->countingPly; }
+
+inline int Position::counting_limit() const { return st->countingLimit; }
+
+// Plies left before the game is drawn by the Makruk counting rules or by the
+// 50-move rule, whichever comes first.
+inline int Position::draw_horizon() const {
+    return st->countingLimit ? std::min(100 - st->rule50, st->countingLimit - st->countingPly)
+                             : 100 - st->rule50;
+}
+
+inline bool Position::is_chess960() const { return !MakrukOnly && chess960; }
 
 inline bool Position::capture(Move m) const {
     assert(m.is_ok());
@@ -285,11 +356,12 @@ inline bool Position::capture(Move m) const {
 }
 
 // Returns true if a move is generated from the capture stage, having also
-// queen promotions covered, i.e. consistency with the capture stage move generation
-// is needed to avoid the generation of duplicate moves.
+// queen promotions covered in chess, i.e. consistency with the capture stage move
+// generation is needed to avoid the generation of duplicate moves. A Makruk pawn
+// only promotes to a met, so its promotions without capture are quiet moves.
 inline bool Position::capture_stage(Move m) const {
     assert(m.is_ok());
-    return capture(m) || m.promotion_type() == QUEEN;
+    return capture(m) || (!MakrukOnly && m.promotion_type() == QUEEN);
 }
 
 inline Piece Position::captured_piece() const { return st->capturedPiece; }
@@ -301,11 +373,13 @@ inline void Position::put_piece(Piece pc, Square s) {
     byColorBB[color_of(pc)] |= s;
     pieceCount[pc]++;
     pieceCount[make_piece(color_of(pc), ALL_PIECES)]++;
+    update_attacks<true>(pc, s);
 }
 
 inline void Position::remove_piece(Square s) {
 
     Piece pc = board[s];
+    update_attacks<false>(pc, s);
     byTypeBB[ALL_PIECES] ^= s;
     byTypeBB[type_of(pc)] ^= s;
     byColorBB[color_of(pc)] ^= s;
@@ -323,6 +397,39 @@ inline void Position::move_piece(Square from, Square to) {
     byColorBB[color_of(pc)] ^= fromTo;
     board[from] = NO_PIECE;
     board[to]   = pc;
+    update_attacks<false>(pc, from);
+    update_attacks<true>(pc, to);
+}
+
+// Keeps the attack counts of the leapers up to date as pieces are put on and
+// removed from the board. Their attacks do not depend on the occupancy, so a
+// move only touches the squares attacked from its origin and destination.
+// Rooks and queens are left out: they are at most two per side and their rays
+// change with every move, so they are computed when needed.
+template<bool Add>
+inline void Position::update_attacks([[maybe_unused]] Piece pc, [[maybe_unused]] Square s) {
+
+#if defined(USE_ATTACK_MAPS)
+    const PieceType pt = type_of(pc);
+
+    if (pt == ROOK || pt == QUEEN)
+        return;
+
+    const Color c = color_of(pc);
+
+    for (Bitboard b = pt == PAWN ? pawn_attacks_bb(c, s) : attacks_bb(pt, s, 0); b;)
+    {
+        const Square sq = pop_lsb(b);
+
+        if constexpr (Add)
+        {
+            if (!attackCount[c][sq]++)
+                attackedBy[c] |= sq;
+        }
+        else if (!--attackCount[c][sq])
+            attackedBy[c] ^= sq;
+    }
+#endif
 }
 
 inline void Position::do_move(Move m, StateInfo& newSt) { do_move(m, newSt, gives_check(m)); }
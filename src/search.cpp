@@ -31,13 +31,15 @@
 #include <sstream>
 
 #include "evaluate.h"
+#include "memory.h"
 #include "misc.h"
 #include "movegen.h"
 #include "movepick.h"
 #include "nnue/evaluate_nnue.h"
 #include "nnue/nnue_common.h"
 #include "position.h"
-// #include "syzygy/tbprobe.h"
+#include "bitbase/bitbase.h"
+#include "analysis/analysis.h"
 #include "thread.h"
 #include "timeman.h"
 #include "tt.h"
@@ -59,12 +61,10 @@ extern "C" {
 // livebook end
 
 // Kelly begin
-bool                               useLearning          = true;
-bool                               enabledLearningProbe = false;
 std::vector<PersistedLearningMove> gameLine;
 // Kelly end
 
-// namespace TB = Tablebases;
+namespace TB = Bitbases;
 
 using Eval::evaluate;
 using namespace Search;
@@ -122,13 +122,8 @@ struct Skill {
     Move   best = Move::none();
 };
 
-//opening variety begin
-int openingVariety;
-//opening variety end
-
-
 Value value_to_tt(Value v, int ply);
-Value value_from_tt(Value v, int ply, int r50c);
+Value value_from_tt(Value v, int ply, int pliesToDraw);
 void  update_pv(Move* pv, Move move, const Move* childPv);
 void  update_continuation_histories(Stack* ss, Piece pc, Square to, int bonus);
 void  update_quiet_stats(
@@ -167,6 +162,7 @@ size_t cURL_WriteFunc(void* contents, size_t size, size_t nmemb, std::string* s)
         // handle memory problem
         return 0;
     }
+    Memory::set(Memory::LIVEBOOK, s->capacity());
     return newLength;
 }
     bool egtbs=false;
@@ -221,7 +217,7 @@ inline Value static_value(Position& pos, Stack* ss, int optimism) {
         return VALUE_DRAW;
 
     // Detect mate and stalemate situations
-    if (MoveList<LEGAL>(pos).size() == 0)
+    if (!has_any_legal_move(pos))
         return pos.checkers() ? VALUE_MATE : VALUE_DRAW;
 
     //Should not call evaluate() if the side to move is under check!
@@ -243,33 +239,56 @@ Search::Worker::Worker(SharedState&                    sharedState,
     evalFiles(sharedState.evalFiles),
     options(sharedState.options),
     threads(sharedState.threads),
-    tt(sharedState.tt) {
+    tt(sharedState.tt),
+    ttCache(sharedState.tt) {
+    ponderGroup = 0;
+    detached    = false;
     clear();
 }
 
 void Search::Worker::start_searching() {
+
+    openingVariety = options["Opening variety"];  // from Sugar
+
     // Non-main threads go directly to iterative_deepening()
     if (!is_mainthread())
     {
         iterative_deepening();
+
+        // After a 'ponderhit' the threads that pondered on other replies are
+        // detached, and continue with the search of the played move.
+        if (detached && !threads.stop)
+        {
+            threads.join_main_search(*this);
+            iterative_deepening();
+        }
+
+        ttCache.flush();
         return;
     }
 
     main_manager()->tm.init(limits, rootPos.side_to_move(), rootPos.game_ply(), options);
     tt.new_search();
+
+    const bool ponder = main_manager()->ponder;
+
+    if (limits.use_time_management() && !limits.silent)
+        if (const std::string figures = main_manager()->tm.telemetry(); !figures.empty())
+            sync_cout << "info string " << figures << sync_endl;
+
     // Kelly begin
-    enabledLearningProbe = false;
-    useLearning          = true;
+    threads.enabledLearningProbe = false;
+    threads.useLearning          = true;
     // Kelly end
 
-    openingVariety = options["Opening variety"];  // from Sugar
-    Move bookMove  = Move::none();                //Books management
+    Move bookMove = Move::none();  //Books management
 
     if (rootMoves.empty())
     {
         rootMoves.emplace_back(Move::none());
-        sync_cout << "info depth 0 score "
-                  << UCI::value(rootPos.checkers() ? -VALUE_MATE : VALUE_DRAW) << sync_endl;
+        if (!limits.silent)
+            sync_cout << "info depth 0 score "
+                      << UCI::value(rootPos.checkers() ? -VALUE_MATE : VALUE_DRAW) << sync_endl;
     }
     else
     // Books management begin
@@ -296,7 +315,8 @@ void Search::Worker::start_searching() {
 #ifdef USE_LIVEBOOK
         if ((think) && (!bookMove))
         {  
-            if (!off && g_inBook && !limits.infinite && !limits.mate)
+            // The in-process games share the cURL handle, and must not query the web
+            if (!off && g_inBook && !limits.infinite && !limits.mate && !limits.silent)
             {
                 //livebook _depth begin
                 if (rootPos.game_ply() == 0)
@@ -358,10 +378,16 @@ void Search::Worker::start_searching() {
         //from Book and live book management begin
         if (!bookMove || think)
         {
-            //Initialize `mctsThreads` threads only once before any thread have begun searching
-            mctsThreads        = size_t(int(options["MCTSThreads"]));
-            mctsMultiStrategy  = size_t(int(options["MCTS Multi Strategy"]));
-            mctsMultiMinVisits = double(int(options["MCTS Multi MinVisits"]));
+            //Initialize `mctsThreads` threads only once before any thread have begun searching.
+            //The tree and its settings are process-wide, so only a search using them writes them.
+            const size_t mctsQuota = size_t(int(options["MCTSThreads"]));
+            if (options["MCTS"])
+            {
+                mctsThreads        = mctsQuota;
+                mctsMultiStrategy  = size_t(int(options["MCTS Multi Strategy"]));
+                mctsMultiMinVisits = double(int(options["MCTS Multi MinVisits"]));
+            }
+            threads.init_mcts(mctsQuota, bool(options["MCTS Dynamic Threads"]));
 
             threads.start_searching();  // start non-main threads
             iterative_deepening();      // main thread start searching
@@ -385,6 +411,9 @@ void Search::Worker::start_searching() {
     // Wait until all threads have finished
     threads.wait_for_search_finished();
 
+    // The helpers have written back their caches when they stopped
+    ttCache.flush();
+
     // When playing in 'nodes as time' mode, subtract the searched nodes from
     // the available ones before exiting.
     if (limits.npmsec)
@@ -425,25 +454,41 @@ void Search::Worker::start_searching() {
                 LD.add_new_learning(plm.key, plm.learningMove);
             }
         }
-        if (!enabledLearningProbe)
+        if (!threads.enabledLearningProbe)
         {
-            useLearning = false;
+            threads.useLearning = false;
         }
     }
     // Kelly end
 
-    // Send again PV info if we have a new best thread
-    if (bestThread != this)
-        sync_cout << main_manager()->pv(*bestThread, threads, tt, bestThread->completedDepth)
-                  << sync_endl;
+    main_manager()->bestMove  = bestThread->rootMoves[0].pv[0];
+    main_manager()->bestValue = bestThread->rootMoves[0].score;
 
-    sync_cout << "bestmove " << UCI::move(bestThread->rootMoves[0].pv[0], rootPos.is_chess960());
+    if (!limits.silent)
+    {
+        // Send again PV info if we have a new best thread
+        if (bestThread != this)
+            sync_cout << main_manager()->pv(*bestThread, threads, tt, bestThread->completedDepth)
+                      << sync_endl;
 
-    if (bestThread->rootMoves[0].pv.size() > 1
-        || bestThread->rootMoves[0].extract_ponder_from_tt(tt, rootPos))
-        std::cout << " ponder " << UCI::move(bestThread->rootMoves[0].pv[1], rootPos.is_chess960());
+        std::string ponderMove;
 
-    std::cout << sync_endl;
+        if (bestThread->rootMoves[0].pv.size() > 1
+            || bestThread->rootMoves[0].extract_ponder_from_tt(tt, rootPos))
+            ponderMove =
+              " ponder " + UCI::move(bestThread->rootMoves[0].pv[1], rootPos.is_chess960());
+
+        sync_cout << "bestmove "
+                  << UCI::move(bestThread->rootMoves[0].pv[0], rootPos.is_chess960())
+                  << ponderMove << sync_endl;
+    }
+
+    main_manager()->tm.record(limits, rootPos.side_to_move(), threads.nodes_searched(), ponder);
+
+    // The cache file is written after bestmove, so that its I/O delays neither
+    // the move nor the latency measured by the time manager
+    if (!bookMove && !limits.silent && limits.searchmoves.empty() && !tbConfig.rootInTB)
+        Analysis::store(rootPos, options, bestThread->completedDepth, bestThread->rootMoves);
 
     // from Khalid begin
     // Save learning data if game is already decided
@@ -482,6 +527,11 @@ void Search::Worker::start_searching() {
     // livebook end
 }
 
+bool Search::Worker::stopped() const {
+    return threads.stop.load(std::memory_order_relaxed)
+        || detached.load(std::memory_order_relaxed);
+}
+
 // Main iterative deepening loop. It calls search()
 // repeatedly with increasing depth until the allocated thinking time has been
 // consumed, the user stops the search, or the maximum search depth is reached.
@@ -537,43 +587,54 @@ void Search::Worker::iterative_deepening() {
 
     multiPV = std::min(multiPV, rootMoves.size());
 
+    cascade = {bool(options["Cascaded Eval"]), int(options["Cascaded Eval Margin"]),
+               int(options["Cascaded Eval Complexity"])};
+
+    // Allocated by the thread itself, so that it is local to its NUMA node
+    ttCache.resize(size_t(int(options["Thread Hash"])) * 1024);
+
     int searchAgainCounter = 0;
 
     // from mcts begin
     optimism[WHITE] = optimism[BLACK] =
       VALUE_ZERO;  //Must initialize optimism before calling static_value(). Not sure if 'VALUE_ZERO' is the right value
 
-    bool  maybeDraw           = rootPos.rule50_count() >= 90 || rootPos.has_game_cycle(2);
+    bool  maybeDraw           = rootPos.draw_horizon() <= 10 || rootPos.has_game_cycle(2);
     Value rootPosValue        = static_value(rootPos, ss, this->optimism[us]);
     bool  possibleMCTSByValue = (rootPosValue <= -MIDDLE_MCTS);
+    bool  mcts                = bool(options["MCTS"]) && multiPV == 1 && !maybeDraw
+                  && possibleMCTSByValue && !is_game_decided(rootPos, rootPosValue);
+    bool  dynamicMcts         = mcts && bool(options["MCTS Dynamic Threads"]);
 
-    if (!mainThread && bool(options["MCTS"]) && multiPV == 1 && !maybeDraw && possibleMCTSByValue
-        && ((this->thread_idx) <= (size_t) (mctsThreads))
-        && !is_game_decided(rootPos, rootPosValue))
-    {
+    // Runs the Monte-Carlo search until the search stops or the scheduler moves
+    // this helper back to alpha-beta, which then goes on where it was left.
+    auto run_mcts = [&]() {
         MonteCarlo* monteCarlo = new MonteCarlo(rootPos, this);
 
-        if (monteCarlo)
-        {
 #if !defined(NDEBUG) && !defined(_NDEBUG)
-            sync_cout << "info string *** Thread[" << thread_idx << "] is running MCTS search"
-                      << sync_endl;
+        sync_cout << "info string *** Thread[" << thread_idx << "] is running MCTS search"
+                  << sync_endl;
 #endif
 
-            monteCarlo->search(threads, limits, is_mainthread(), this, tt);
-            if ((this->thread_idx) == 1 && limits.infinite
-                && threads.stop.load(std::memory_order_relaxed))
-                monteCarlo->print_children();
+        monteCarlo->search(threads, limits, is_mainthread(), this, tt);
+        if ((this->thread_idx) == 1 && limits.infinite
+            && threads.stop.load(std::memory_order_relaxed))
+            monteCarlo->print_children();
 
-            delete monteCarlo;
+        delete monteCarlo;
 
 #if !defined(NDEBUG) && !defined(_NDEBUG)
-            sync_cout << "info string *** Thread[" << thread_idx << "] finished MCTS search"
-                      << sync_endl;
+        sync_cout << "info string *** Thread[" << thread_idx << "] finished MCTS search"
+                  << sync_endl;
 #endif
+    };
 
+    if (!mainThread && mcts && threads.runs_mcts(thread_idx))
+    {
+        run_mcts();
+
+        if (!dynamicMcts || stopped())
             return;
-        }
     }
 
 #if !defined(NDEBUG) && !defined(_NDEBUG)
@@ -581,10 +642,23 @@ void Search::Worker::iterative_deepening() {
 #endif
 
     // from mcts end
+    // A search resumed from a previous one shows its result at once
+    if (mainThread && completedDepth && !limits.silent)
+        sync_cout << main_manager()->pv(*this, threads, tt, completedDepth) << sync_endl;
+
     // Iterative deepening loop until requested to stop or the target depth is reached
-    while (++rootDepth < MAX_PLY && !threads.stop
+    while (++rootDepth < MAX_PLY && !stopped()
            && !(limits.depth && mainThread && rootDepth > limits.depth))
     {
+        // The scheduler may have moved this helper to the Monte-Carlo search
+        if (!mainThread && dynamicMcts && threads.runs_mcts(thread_idx))
+        {
+            run_mcts();
+
+            if (stopped())
+                break;
+        }
+
         // Age out PV variability metric
         if (mainThread)
             totBestMoveChanges /= 2;
@@ -601,7 +675,7 @@ void Search::Worker::iterative_deepening() {
             searchAgainCounter++;
 
         // MultiPV loop. We perform a full root search for each PV line
-        for (pvIdx = 0; pvIdx < multiPV && !threads.stop; ++pvIdx)
+        for (pvIdx = 0; pvIdx < multiPV && !stopped(); ++pvIdx)
         {
             if (pvIdx == pvLast)
             {
@@ -647,13 +721,13 @@ void Search::Worker::iterative_deepening() {
                 // If search has been stopped, we break immediately. Sorting is
                 // safe because RootMoves is still valid, although it refers to
                 // the previous iteration.
-                if (threads.stop)
+                if (stopped())
                     break;
 
                 // When failing high/low give some update (without cluttering
                 // the UI) before a re-search.
                 if (mainThread && multiPV == 1 && (bestValue <= alpha || bestValue >= beta)
-                    && mainThread->tm.elapsed(threads.nodes_searched()) > 3000)
+                    && !limits.silent && mainThread->tm.elapsed(threads.nodes_searched()) > 3000)
                     sync_cout << main_manager()->pv(*this, threads, tt, rootDepth) << sync_endl;
 
                 // In case of failing low/high increase aspiration window and
@@ -683,7 +757,7 @@ void Search::Worker::iterative_deepening() {
             // Sort the PV lines searched so far and update the GUI
             std::stable_sort(rootMoves.begin() + pvFirst, rootMoves.begin() + pvIdx + 1);
 
-            if (mainThread
+            if (mainThread && !limits.silent
                 && (threads.stop || pvIdx + 1 == multiPV
                     || mainThread->tm.elapsed(threads.nodes_searched()) > 3000)
                 // A thread that aborted search can have mated-in/TB-loss PV and score
@@ -694,7 +768,7 @@ void Search::Worker::iterative_deepening() {
                 sync_cout << main_manager()->pv(*this, threads, tt, rootDepth) << sync_endl;
         }
 
-        if (!threads.stop)
+        if (!stopped())
             completedDepth = rootDepth;
 
         // We make sure not to pick an unproven mated-in score,
@@ -734,6 +808,11 @@ void Search::Worker::iterative_deepening() {
             th->worker->bestMoveChanges = 0;
         }
 
+        // Spend the helpers on the search that pays off, alpha-beta while its
+        // last iterations changed the best move or MCTS while its visits focus
+        if (dynamicMcts && completedDepth >= 6)
+            threads.rebalance_mcts(rootMoves[0].pv[0], lastBestMoveDepth + 2 >= completedDepth);
+
         // Do we have time for the next iteration? Can we stop searching now?
         if (limits.use_time_management() && !threads.stop && !mainThread->stopOnPonderhit)
         {
@@ -799,6 +878,7 @@ void Search::Worker::iterative_deepening() {
 }
 
 void Search::Worker::clear() {
+    ttCache.clear();
     counterMoves.fill(Move::none());
     mainHistory.fill(0);
     captureHistory.fill(0);
@@ -815,6 +895,10 @@ void Search::Worker::clear() {
         reductions[i] = int((18.79 + std::log(size_t(options["Threads"])) / 2) * std::log(i));
 // livebook begin
 #ifdef USE_LIVEBOOK
+    // The workers are cleared in parallel, and the handle is shared
+    if (!is_mainthread())
+        return;
+
     curl_global_init(CURL_GLOBAL_DEFAULT);
     g_cURL = curl_easy_init();
     curl_easy_setopt(g_cURL, CURLOPT_TIMEOUT_MS, 1500L);
@@ -897,8 +981,7 @@ Value Search::Worker::search(
     if (!rootNode)
     {
         // Step 2. Check for aborted search and immediate draw
-        if (threads.stop.load(std::memory_order_relaxed) || pos.is_draw(ss->ply)
-            || ss->ply >= MAX_PLY)
+        if (stopped() || pos.is_draw(ss->ply) || ss->ply >= MAX_PLY)
             return (ss->ply >= MAX_PLY && !ss->inCheck) ? evaluate(pos, thisThread->optimism[us])
                                                         : value_draw(thisThread->nodes);
 
@@ -928,8 +1011,8 @@ Value Search::Worker::search(
     // Step 4. Transposition table lookup.
     excludedMove = ss->excludedMove;
     posKey       = pos.key();
-    tte          = tt.probe(posKey, ss->ttHit);
-    ttValue   = ss->ttHit ? value_from_tt(tte->value(), ss->ply, pos.rule50_count()) : VALUE_NONE;
+    tte          = ttCache.probe(posKey, depth, ss->ttHit);
+    ttValue   = ss->ttHit ? value_from_tt(tte->value(), ss->ply, pos.draw_horizon()) : VALUE_NONE;
     ttMove    = rootNode  ? thisThread->rootMoves[thisThread->pvIdx].pv[0]
               : ss->ttHit ? tte->move()
                           : Move::none();
@@ -963,8 +1046,8 @@ Value Search::Worker::search(
         }
 
         // Partial workaround for the graph history interaction problem
-        // For high rule50 counts don't produce transposition table cutoffs.
-        if (pos.rule50_count() < 90)
+        // Close to a draw by rule don't produce transposition table cutoffs.
+        if (pos.draw_horizon() > 10)
             return ttValue >= beta && std::abs(ttValue) < VALUE_TB_WIN_IN_MAX_PLY
                    ? (ttValue * 3 + beta) / 4
                    : ttValue;
@@ -974,7 +1057,7 @@ Value Search::Worker::search(
     expTTHit        = false;
     updatedLearning = false;
 
-    if (!excludedMove && LD.is_enabled() && useLearning)
+    if (!excludedMove && LD.is_enabled() && threads.useLearning)
     {
         const LearningMove* learningMove = nullptr;
         sibs                             = LD.probeByMaxDepthAndScore(posKey, learningMove);
@@ -982,8 +1065,8 @@ Value Search::Worker::search(
         {
             assert(sibs);
 
-            enabledLearningProbe = true;
-            expTTHit             = true;
+            threads.enabledLearningProbe = true;
+            expTTHit                     = true;
             if (!ttMove)
             {
                 ttMove = learningMove->move;
@@ -1044,25 +1127,25 @@ Value Search::Worker::search(
                 }
 
                 // thisThread->tbHits.fetch_add(1, std::memory_order_relaxed);
-                if (pos.rule50_count() < 90)
+                if (pos.draw_horizon() > 10)
                     return expTTValue;
             }
         }
     }
     // from Kelly end
 
-    /*
-    // Step 5. Tablebases probe
+    // Step 5. Bitbases probe
     if (!rootNode && !excludedMove && tbConfig.cardinality)
     {
         int piecesCount = pos.count<ALL_PIECES>();
 
         if (piecesCount <= tbConfig.cardinality
             && (piecesCount < tbConfig.cardinality || depth >= tbConfig.probeDepth)
-            && pos.rule50_count() == 0)
+            && (tbConfig.useCounting && pos.counting_limit() ? !pos.counting_ply()
+                                                             : pos.rule50_count() == 0))
         {
             TB::ProbeState err;
-            TB::WDLScore   wdl = Tablebases::probe_wdl(pos, &err);
+            TB::WDLScore   wdl = TB::probe_wdl(pos, &err);
 
             // Force check of time on the next occasion
             if (is_mainthread())
@@ -1072,7 +1155,7 @@ Value Search::Worker::search(
             {
                 thisThread->tbHits.fetch_add(1, std::memory_order_relaxed);
 
-                int drawScore = tbConfig.useRule50 ? 1 : 0;
+                int drawScore = tbConfig.useCounting ? 1 : 0;
 
                 Value tbValue = VALUE_TB - ss->ply;
 
@@ -1087,9 +1170,8 @@ Value Search::Worker::search(
 
                 if (b == BOUND_EXACT || (b == BOUND_LOWER ? value >= beta : value <= alpha))
                 {
-                    tte->save(posKey, value_to_tt(value, ss->ply), ss->ttPv, b,
-                              std::min(MAX_PLY - 1, depth + 6), Move::none(), VALUE_NONE,
-                              tt.generation());
+                    ttCache.save(tte, posKey, value_to_tt(value, ss->ply), ss->ttPv, b,
+                                 std::min(MAX_PLY - 1, depth + 6), Move::none(), VALUE_NONE);
 
                     return value;
                 }
@@ -1105,8 +1187,6 @@ Value Search::Worker::search(
         }
     }
 
-    */
-
     // Step 6. Static evaluation of the position
     Value unadjustedStaticEval = VALUE_NONE;
     if (ss->inCheck)
@@ -1120,7 +1200,7 @@ Value Search::Worker::search(
     {
         // Providing the hint that this node's accumulator will be used often
         // brings significant Elo gain (~13 Elo).
-        Eval::NNUE::hint_common_parent_position(pos);
+        Eval::NNUE::hint_common_parent_position(pos, thisThread->cascade.enabled);
         unadjustedStaticEval = eval = ss->staticEval;
     }
     else if (ss->ttHit)
@@ -1128,9 +1208,10 @@ Value Search::Worker::search(
         // Never assume anything about values stored in TT
         unadjustedStaticEval = tte->eval();
         if (unadjustedStaticEval == VALUE_NONE)
-            unadjustedStaticEval = evaluate(pos, thisThread->optimism[us]);
+            unadjustedStaticEval =
+              evaluate(pos, thisThread->optimism[us], alpha, beta, thisThread->cascade);
         else if (PvNode)
-            Eval::NNUE::hint_common_parent_position(pos);
+            Eval::NNUE::hint_common_parent_position(pos, thisThread->cascade.enabled);
 
         ss->staticEval = eval = to_corrected_static_eval(unadjustedStaticEval, *thisThread, pos);
 
@@ -1141,7 +1222,8 @@ Value Search::Worker::search(
     else
     {
         //Kelly begin
-        unadjustedStaticEval = evaluate(pos, thisThread->optimism[us]);
+        unadjustedStaticEval =
+          evaluate(pos, thisThread->optimism[us], alpha, beta, thisThread->cascade);
 
 
         if (!(expTTHit) || !(updatedLearning))
@@ -1150,8 +1232,8 @@ Value Search::Worker::search(
               to_corrected_static_eval(unadjustedStaticEval, *thisThread, pos);
 
             // Static evaluation is saved as it was before adjustment by correction history
-            tte->save(posKey, VALUE_NONE, ss->ttPv, BOUND_NONE, DEPTH_NONE, Move::none(),
-                      unadjustedStaticEval, tt.generation());
+            ttCache.save(tte, posKey, VALUE_NONE, ss->ttPv, BOUND_NONE, DEPTH_NONE, Move::none(),
+                         unadjustedStaticEval);
         }
         else  // learning
         {
@@ -1310,6 +1392,7 @@ Value Search::Worker::search(
 
                 thisThread->nodes.fetch_add(1, std::memory_order_relaxed);
                 pos.do_move(move, st);
+                Eval::NNUE::prefetch_changed_rows(pos, thisThread->cascade.enabled);
 
                 // Perform a preliminary qsearch to verify that the move holds
                 value = -qsearch<NonPV>(pos, ss + 1, -probCutBeta, -probCutBeta + 1);
@@ -1324,14 +1407,14 @@ Value Search::Worker::search(
                 if (value >= probCutBeta)
                 {
                     // Save ProbCut data into transposition table
-                    tte->save(posKey, value_to_tt(value, ss->ply), ss->ttPv, BOUND_LOWER, depth - 3,
-                              move, unadjustedStaticEval, tt.generation());
+                    ttCache.save(tte, posKey, value_to_tt(value, ss->ply), ss->ttPv, BOUND_LOWER,
+                                 depth - 3, move, unadjustedStaticEval);
                     return std::abs(value) < VALUE_TB_WIN_IN_MAX_PLY ? value - (probCutBeta - beta)
                                                                      : value;
                 }
             }
 
-        Eval::NNUE::hint_common_parent_position(pos);
+        Eval::NNUE::hint_common_parent_position(pos, thisThread->cascade.enabled);
     }
 
 moves_loop:  // When in check, search starts here
@@ -1382,7 +1465,7 @@ moves_loop:  // When in check, search starts here
 
         ss->moveCount = ++moveCount;
 
-        if (rootNode && is_mainthread()
+        if (rootNode && is_mainthread() && !limits.silent
             && main_manager()->tm.elapsed(threads.nodes_searched()) > 3000)
             sync_cout << "info depth " << depth << " currmove "
                       << UCI::move(move, pos.is_chess960()) << " currmovenumber "
@@ -1554,6 +1637,10 @@ moves_loop:  // When in check, search starts here
         thisThread->nodes.fetch_add(1, std::memory_order_relaxed);
         pos.do_move(move, st, givesCheck);
 
+        // Start loading the weights the child will update its accumulators with,
+        // so that they are in cache when it is evaluated
+        Eval::NNUE::prefetch_changed_rows(pos, thisThread->cascade.enabled);
+
         // Decrease reduction if position is or has been on the PV (~7 Elo)
         if (ss->ttPv)
             r -= 1 + (ttValue > alpha) + (tte->depth() >= depth);
@@ -1659,7 +1746,7 @@ moves_loop:  // When in check, search starts here
         // Finished searching the move. If a stop occurred, the return value of
         // the search cannot be trusted, and we return immediately without
         // updating best move, PV and TT.
-        if (threads.stop.load(std::memory_order_relaxed))
+        if (stopped())
             return VALUE_ZERO;
 
         if (rootNode)
@@ -1753,7 +1840,7 @@ moves_loop:  // When in check, search starts here
     // must be a mate or a stalemate. If we are in a singular extension search then
     // return a fail low score.
 
-    assert(moveCount || !ss->inCheck || excludedMove || !MoveList<LEGAL>(pos).size());
+    assert(moveCount || !ss->inCheck || excludedMove || !has_any_legal_move(pos));
 
     // Adjust best value for fail high cases at non-pv nodes
     if (!PvNode && bestValue >= beta && std::abs(bestValue) < VALUE_TB_WIN_IN_MAX_PLY
@@ -1790,11 +1877,11 @@ moves_loop:  // When in check, search starts here
     // Write gathered information in transposition table
     // Static evaluation is saved as it was before correction history
     if (!excludedMove && !(rootNode && thisThread->pvIdx))
-        tte->save(posKey, value_to_tt(bestValue, ss->ply), ss->ttPv,
-                  bestValue >= beta    ? BOUND_LOWER
-                  : PvNode && bestMove ? BOUND_EXACT
-                                       : BOUND_UPPER,
-                  depth, bestMove, unadjustedStaticEval, tt.generation());
+        ttCache.save(tte, posKey, value_to_tt(bestValue, ss->ply), ss->ttPv,
+                     bestValue >= beta    ? BOUND_LOWER
+                     : PvNode && bestMove ? BOUND_EXACT
+                                          : BOUND_UPPER,
+                     depth, bestMove, unadjustedStaticEval);
 
     // Adjust correction history
     if (!ss->inCheck && (!bestMove || !pos.capture(bestMove))
@@ -1875,8 +1962,8 @@ Value Search::Worker::qsearch(Position& pos, Stack* ss, Value alpha, Value beta,
 
     // Step 3. Transposition table lookup
     posKey  = pos.key();
-    tte     = tt.probe(posKey, ss->ttHit);
-    ttValue = ss->ttHit ? value_from_tt(tte->value(), ss->ply, pos.rule50_count()) : VALUE_NONE;
+    tte     = ttCache.probe(posKey, depth, ss->ttHit);
+    ttValue = ss->ttHit ? value_from_tt(tte->value(), ss->ply, pos.draw_horizon()) : VALUE_NONE;
     ttMove  = ss->ttHit ? tte->move() : Move::none();
     pvHit   = ss->ttHit && tte->is_pv();
 
@@ -1897,7 +1984,8 @@ Value Search::Worker::qsearch(Position& pos, Stack* ss, Value alpha, Value beta,
             // Never assume anything about values stored in TT
             unadjustedStaticEval = tte->eval();
             if (unadjustedStaticEval == VALUE_NONE)
-                unadjustedStaticEval = evaluate(pos, thisThread->optimism[us]);
+                unadjustedStaticEval =
+                  evaluate(pos, thisThread->optimism[us], alpha, beta, thisThread->cascade);
             ss->staticEval = bestValue =
               to_corrected_static_eval(unadjustedStaticEval, *thisThread, pos);
 
@@ -1910,7 +1998,8 @@ Value Search::Worker::qsearch(Position& pos, Stack* ss, Value alpha, Value beta,
         {
             // In case of null move search, use previous static eval with a different sign
             unadjustedStaticEval = (ss - 1)->currentMove != Move::null()
-                                   ? evaluate(pos, thisThread->optimism[us])
+                                   ? evaluate(pos, thisThread->optimism[us], alpha, beta,
+                                              thisThread->cascade)
                                    : -(ss - 1)->staticEval;
             ss->staticEval       = bestValue =
               to_corrected_static_eval(unadjustedStaticEval, *thisThread, pos);
@@ -1920,8 +2009,8 @@ Value Search::Worker::qsearch(Position& pos, Stack* ss, Value alpha, Value beta,
         if (bestValue >= beta)
         {
             if (!ss->ttHit)
-                tte->save(posKey, value_to_tt(bestValue, ss->ply), false, BOUND_LOWER, DEPTH_NONE,
-                          Move::none(), unadjustedStaticEval, tt.generation());
+                ttCache.save(tte, posKey, value_to_tt(bestValue, ss->ply), false, BOUND_LOWER,
+                             DEPTH_NONE, Move::none(), unadjustedStaticEval);
 
             return bestValue;
         }
@@ -2027,6 +2116,7 @@ Value Search::Worker::qsearch(Position& pos, Stack* ss, Value alpha, Value beta,
         // Step 7. Make and search the move
         thisThread->nodes.fetch_add(1, std::memory_order_relaxed);
         pos.do_move(move, st, givesCheck);
+        Eval::NNUE::prefetch_changed_rows(pos, thisThread->cascade.enabled);
         value = -qsearch<nodeType>(pos, ss + 1, -beta, -alpha, depth - 1);
         pos.undo_move(move);
 
@@ -2074,7 +2164,7 @@ Value Search::Worker::qsearch(Position& pos, Stack* ss, Value alpha, Value beta,
     // and no legal moves were found, it is checkmate.
     if (ss->inCheck && bestValue == -VALUE_INFINITE)
     {
-        assert(!MoveList<LEGAL>(pos).size());
+        assert(!has_any_legal_move(pos));
         return mated_in(ss->ply);  // Plies to mate from the root
     }
 
@@ -2083,9 +2173,9 @@ Value Search::Worker::qsearch(Position& pos, Stack* ss, Value alpha, Value beta,
 
     // Save gathered info in transposition table
     // Static evaluation is saved as it was before adjustment by correction history
-    tte->save(posKey, value_to_tt(bestValue, ss->ply), pvHit,
-              bestValue >= beta ? BOUND_LOWER : BOUND_UPPER, ttDepth, bestMove,
-              unadjustedStaticEval, tt.generation());
+    ttCache.save(tte, posKey, value_to_tt(bestValue, ss->ply), pvHit,
+                 bestValue >= beta ? BOUND_LOWER : BOUND_UPPER, ttDepth, bestMove,
+                 unadjustedStaticEval);
 
     assert(bestValue > -VALUE_INFINITE && bestValue < VALUE_INFINITE);
 
@@ -2111,9 +2201,10 @@ Value value_to_tt(Value v, int ply) {
 // Inverse of value_to_tt(): it adjusts a mate or TB score
 // from the transposition table (which refers to the plies to mate/be mated from
 // current position) to "plies to mate/be mated (TB win/loss) from the root".
-// However, to avoid potentially false mate or TB scores related to the 50 moves rule
-// and the graph history interaction, we return the highest non-TB score instead.
-Value value_from_tt(Value v, int ply, int r50c) {
+// However, to avoid potentially false mate or TB scores related to the counting rules,
+// the 50 moves rule and the graph history interaction, we return the highest non-TB
+// score instead.
+Value value_from_tt(Value v, int ply, int pliesToDraw) {
 
     if (v == VALUE_NONE)
         return VALUE_NONE;
@@ -2122,11 +2213,11 @@ Value value_from_tt(Value v, int ply, int r50c) {
     if (v >= VALUE_TB_WIN_IN_MAX_PLY)
     {
         // Downgrade a potentially false mate score
-        if (v >= VALUE_MATE_IN_MAX_PLY && VALUE_MATE - v > 100 - r50c)
+        if (v >= VALUE_MATE_IN_MAX_PLY && VALUE_MATE - v > pliesToDraw)
             return VALUE_TB_WIN_IN_MAX_PLY - 1;
 
         // Downgrade a potentially false TB score.
-        if (VALUE_TB - v > 100 - r50c)
+        if (VALUE_TB - v > pliesToDraw)
             return VALUE_TB_WIN_IN_MAX_PLY - 1;
 
         return v - ply;
@@ -2136,11 +2227,11 @@ Value value_from_tt(Value v, int ply, int r50c) {
     if (v <= VALUE_TB_LOSS_IN_MAX_PLY)
     {
         // Downgrade a potentially false mate score.
-        if (v <= VALUE_MATED_IN_MAX_PLY && VALUE_MATE + v > 100 - r50c)
+        if (v <= VALUE_MATED_IN_MAX_PLY && VALUE_MATE + v > pliesToDraw)
             return VALUE_TB_LOSS_IN_MAX_PLY + 1;
 
         // Downgrade a potentially false TB score.
-        if (VALUE_TB + v > 100 - r50c)
+        if (VALUE_TB + v > pliesToDraw)
             return VALUE_TB_LOSS_IN_MAX_PLY + 1;
 
         return v + ply;
@@ -2414,6 +2505,11 @@ void SearchManager::check_time(Search::Worker& worker) {
     {
         lastInfoTime = tick;
         dbg_print();
+
+        // Every "Memory Report" seconds, the figures of the 'memory' command
+        const int interval = worker.options["Memory Report"];
+        if (interval && !worker.limits.silent && ++reportSeconds % interval == 0)
+            sync_cout << Memory::report() << sync_endl;
     }
 
     // We should not stop pondering until told so by the GUI
@@ -2424,7 +2520,7 @@ void SearchManager::check_time(Search::Worker& worker) {
       // Later we rely on the fact that we can at least use the mainthread previous
       // root-search score and PV in a multithreaded environment to prove mated-in scores.
       worker.completedDepth >= 1
-      && ((worker.limits.use_time_management() && (elapsed > tm.maximum() || stopOnPonderhit))
+      && ((worker.limits.use_time_management() && elapsed > tm.maximum()) || stopOnPonderhit
           || (worker.limits.movetime && elapsed >= worker.limits.movetime)
           || (worker.limits.nodes && worker.threads.nodes_searched() >= worker.limits.nodes)))
         worker.threads.stop = worker.threads.abortedSearch = true;
@@ -2442,7 +2538,7 @@ std::string SearchManager::pv(const Search::Worker&     worker,
     size_t      pvIdx     = worker.pvIdx;
     TimePoint   time      = tm.elapsed(nodes) + 1;
     size_t      multiPV   = std::min(size_t(worker.options["MultiPV"]), rootMoves.size());
-    // uint64_t    tbHits    = threads.tb_hits() + (worker.tbConfig.rootInTB ? rootMoves.size() : 0);
+    uint64_t    tbHits    = threads.tb_hits() + (worker.tbConfig.rootInTB ? rootMoves.size() : 0);
 
     for (size_t i = 0; i < multiPV; ++i)
     {
@@ -2457,8 +2553,8 @@ std::string SearchManager::pv(const Search::Worker&     worker,
         if (v == -VALUE_INFINITE)
             v = VALUE_ZERO;
 
-        // bool tb = worker.tbConfig.rootInTB && std::abs(v) <= VALUE_TB;
-        // v       = tb ? rootMoves[i].tbScore : v;
+        bool tb = worker.tbConfig.rootInTB && std::abs(v) <= VALUE_TB;
+        v       = tb ? rootMoves[i].tbScore : v;
 
         if (ss.rdbuf()->in_avail())  // Not at first line
             ss << "\n";
@@ -2470,15 +2566,13 @@ std::string SearchManager::pv(const Search::Worker&     worker,
         if (worker.options["UCI_ShowWDL"])
             ss << UCI::wdl(v, pos.game_ply());
 
-        // if (i == pvIdx && !tb && updated)  // tablebase- and previous-scores are exact
-        //     ss << (rootMoves[i].scoreLowerbound
-        //              ? " lowerbound"
-        //              : (rootMoves[i].scoreUpperbound ? " upperbound" : ""));
+        if (i == pvIdx && !tb && updated)  // bitbase- and previous-scores are exact
+            ss << (rootMoves[i].scoreLowerbound
+                     ? " lowerbound"
+                     : (rootMoves[i].scoreUpperbound ? " upperbound" : ""));
 
-        // ss << " nodes " << nodes << " nps " << nodes * 1000 / time << " hashfull " << tt.hashfull()
-        //    << " tbhits " << tbHits << " time " << time << " pv";
         ss << " nodes " << nodes << " nps " << nodes * 1000 / time << " hashfull " << tt.hashfull()
-           << " time " << time << " pv";
+           << " tbhits " << tbHits << " time " << time << " pv";
 
         for (Move m : rootMoves[i].pv)
             ss << " " << UCI::move(m, pos.is_chess960());
@@ -2541,10 +2635,7 @@ void putGameLineIntoLearningTable() {
     }
 }
 
-void setStartPoint() {
-    useLearning = true;
-    LD.resume();
-}
+void setStartPoint() { LD.resume(); }
 // Kelly end
 
 }  // namespace Brainlearn
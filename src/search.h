@@ -31,8 +31,9 @@
 #include "misc.h"
 #include "movepick.h"
 #include "position.h"
-// #include "syzygy/tbprobe.h"
+#include "bitbase/bitbase.h"
 #include "timeman.h"
+#include "tt.h"
 //from Brainlearn begin
 #include "evaluate.h"
 #include "book/book_manager.h"
@@ -122,6 +123,8 @@ struct LimitsType {
         time[WHITE] = time[BLACK] = inc[WHITE] = inc[BLACK] = npmsec = movetime = TimePoint(0);
         movestogo = depth = mate = perft = infinite = 0;
         nodes                                       = 0;
+        silent                                      = false;
+        ponderMove                                  = Move::none();
     }
 
     bool use_time_management() const { return time[WHITE] || time[BLACK]; }
@@ -130,6 +133,8 @@ struct LimitsType {
     TimePoint         time[COLOR_NB], inc[COLOR_NB], npmsec, movetime, startTime;
     int               movestogo, depth, mate, perft, infinite;
     uint64_t          nodes;
+    bool              silent;      // No UCI output, for the in-process games (selfplay, ...)
+    Move              ponderMove;  // Last move of a 'go ponder' position, the expected reply
 };
 
 
@@ -179,13 +184,18 @@ class SearchManager: public ISearchManager {
 
     Brainlearn::TimeManagement tm;
     int                        callsCnt;
+    int                        reportSeconds = 0;  // Seconds counted for the "Memory Report"
     std::atomic_bool           ponder;
+    std::atomic_bool           stopOnPonderhit;  // Also set by an MCTS thread proving the root
 
     std::array<Value, 4> iterValue;
     double               previousTimeReduction;
     Value                bestPreviousScore;
     Value                bestPreviousAverageScore;
-    bool                 stopOnPonderhit;
+
+    // Outcome of the last search, read back by the in-process games
+    Move  bestMove;
+    Value bestValue;
 
     size_t id;
 };
@@ -230,6 +240,10 @@ class Worker {
    private:
     void iterative_deepening();
 
+    // True when the search has been stopped, or this thread pondered on a reply
+    // that was not played and has to join the main search.
+    bool stopped() const;
+
     // Main search function for both PV and non-PV nodes
     template<NodeType nodeType>
     Value search(Position& pos, Stack* ss, Value alpha, Value beta, Depth depth, bool cutNode);
@@ -256,9 +270,21 @@ class Worker {
     int                   selDepth, nmpMinPly;
 
     Value optimism[COLOR_NB];
+    int   openingVariety;  // from Sugar, read from the options at every search
+
+    Eval::Cascade cascade;
 
     Position  rootPos;
     StateInfo rootState;
+
+    // With 'Ponder Candidates' the threads of the pool are split across the
+    // likely replies of the opponent. ponderGroup is the index of the reply this
+    // thread searches, 0 being the expected one. For the other replies rootState
+    // is the position before the expected reply, and the reply is played from
+    // it into ponderState.
+    size_t           ponderGroup;
+    StateInfo        ponderState;
+    std::atomic_bool detached;
     //mcts
     Depth rootDepth;  //mcts
     Value rootDelta;
@@ -271,7 +297,7 @@ class Worker {
     // The main thread has a SearchManager, the others have a NullSearchManager
     std::unique_ptr<ISearchManager> manager;
 
-    // Tablebases::Config tbConfig;
+    Bitbases::Config tbConfig;
     //From PolyFish begin
     BookManager&           bookMan;
     Eval::NNUE::EvalFiles& evalFiles;
@@ -279,6 +305,7 @@ class Worker {
     const OptionsMap&   options;
     ThreadPool&         threads;
     TranspositionTable& tt;
+    TTCache             ttCache;
 
     friend class Brainlearn::ThreadPool;
     friend class SearchManager;
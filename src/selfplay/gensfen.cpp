@@ -0,0 +1,346 @@
+/*
+  Brainlearn, a UCI chess playing engine derived from Stockfish
+  Copyright (C) 2004-2024 Andrea Manzo, K.Kiniama and Brainlearn developers (see AUTHORS file)
+
+  Brainlearn is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Brainlearn is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "gensfen.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../learn/learn.h"
+#include "../misc.h"
+#include "../movegen.h"
+#include "../uci.h"
+
+namespace Brainlearn::SelfPlay {
+
+namespace {
+
+constexpr auto StartFEN = "rnsmksnr/8/pppppppp/8/8/PPPPPPPP/8/RNSKMSNR w 0 1";
+
+// The last byte is the format version: "MKSF" files stored the moves as their
+// index in the legal move list, which a change to the move generator breaks.
+constexpr char   BlockMagic[] = {'M', 'K', 'S', '2'};
+constexpr size_t BlockSize    = 1 << 20;  // Blocks are written once they exceed this size
+
+void put_u16(std::string& buf, uint16_t v) {
+    buf += char(v);
+    buf += char(v >> 8);
+}
+
+uint16_t get_u16(const char* p) { return uint16_t(uint8_t(p[0]) | uint8_t(p[1]) << 8); }
+
+void put_u32(std::string& buf, uint32_t v) {
+    for (int i = 0; i < 4; ++i)
+        buf += char(v >> (8 * i));
+}
+
+uint32_t get_u32(const char* p) {
+    uint32_t v = 0;
+    for (int i = 0; i < 4; ++i)
+        v |= uint32_t(uint8_t(p[i])) << (8 * i);
+    return v;
+}
+
+void put_varint(std::string& buf, uint64_t v) {
+    for (; v >= 0x80; v >>= 7)
+        buf += char(v | 0x80);
+    buf += char(v);
+}
+
+bool get_varint(const std::string& buf, size_t& cursor, uint64_t& v) {
+    v = 0;
+    for (int shift = 0; cursor < buf.size() && shift < 64; shift += 7)
+    {
+        const uint8_t b = buf[cursor++];
+        v |= uint64_t(b & 0x7F) << shift;
+        if (!(b & 0x80))
+            return true;
+    }
+    return false;
+}
+
+uint64_t zigzag(int64_t v) { return (uint64_t(v) << 1) ^ uint64_t(v >> 63); }
+int64_t  unzigzag(uint64_t v) { return int64_t(v >> 1) ^ -int64_t(v & 1); }
+
+struct PlyRecord {
+    Move  move;
+    Value score;
+    bool  recorded;
+};
+
+// Plays a randomized game and appends it to 'buf', returning the number of
+// positions recorded.
+uint64_t play(Player& player, PRNG& rng, const GenConfig& config, std::string& buf) {
+
+    StateListPtr           states(new std::deque<StateInfo>(1));
+    Position               pos;
+    std::vector<Move>      moves;
+    std::vector<PlyRecord> plies;
+    std::vector<bool>      randomPly(std::max(config.randomPly, 0));
+    GameResult             result;
+    std::string            termination;
+    uint64_t               recorded = 0;
+
+    pos.set(StartFEN, false, &states->back());
+    player.new_game();
+
+    for (int i = 0, n = std::min(config.randomMoves, int(randomPly.size())); i < n;)
+    {
+        const size_t ply = rng.rand<uint64_t>() % randomPly.size();
+        if (!randomPly[ply])
+            randomPly[ply] = true, ++i;
+    }
+
+    while (!adjudicate(pos, int(moves.size()), result, termination))
+    {
+        const Color     us = pos.side_to_move();
+        MoveList<LEGAL> legal(pos);
+        Move            m;
+        Value           v      = VALUE_ZERO;
+        bool            record = false;
+
+        if (moves.size() < randomPly.size() && randomPly[moves.size()])
+            m = *(legal.begin() + rng.rand<uint64_t>() % legal.size());
+        else
+        {
+            Search::LimitsType limits;
+            limits.depth     = config.nodes ? 0 : config.depth;
+            limits.nodes     = config.nodes;
+            limits.startTime = now();
+
+            m = player.go(StartFEN, moves, limits, &v);
+
+            // A game with an illegal move from the search is dropped
+            if (!legal.contains(m))
+                return 0;
+
+            // The game is decided, adjudicate it before the mate scores
+            if (std::abs(v) >= config.evalLimit)
+            {
+                result = (v > 0) == (us == WHITE) ? WHITE_WINS : BLACK_WINS;
+                break;
+            }
+
+            record = int(moves.size()) >= config.writeMinPly
+                  && !(config.noChecks && pos.checkers())
+                  && !(config.noCaptures && pos.capture_stage(m))
+                  && !(config.quiet
+                       && (pos.checkers() || pos.capture_stage(m) || pos.captured_piece()));
+        }
+
+        plies.push_back({m, v, record});
+        recorded += record;
+
+        moves.push_back(m);
+        states->emplace_back();
+        pos.do_move(m, states->back());
+    }
+
+    put_varint(buf, std::string(StartFEN).size());
+    buf += StartFEN;
+    buf += char(result == WHITE_WINS ? 1 : result == BLACK_WINS ? -1 : 0);
+    put_varint(buf, plies.size());
+
+    for (const auto& p : plies)
+    {
+        put_u16(buf, p.move.raw());
+        put_varint(buf, (zigzag(p.score) << 1) | p.recorded);
+    }
+
+    return recorded;
+}
+
+}  // namespace
+
+
+TrainingDataReader::TrainingDataReader(const std::string& file) :
+    in(file, std::ios::binary) {}
+
+bool TrainingDataReader::read_block() {
+
+    char header[12];
+
+    if (!in.read(header, sizeof(header)) || !std::equal(BlockMagic, BlockMagic + 4, header))
+        return false;
+
+    block.resize(get_u32(header + 4));
+    cursor = 0;
+
+    return bool(in.read(block.data(), block.size()));
+}
+
+bool TrainingDataReader::start_game() {
+
+    if (cursor >= block.size() && !read_block())
+        return false;
+
+    uint64_t size, count;
+
+    if (!get_varint(block, cursor, size) || cursor + size + 1 > block.size())
+        return false;
+
+    const std::string fen = block.substr(cursor, size);
+    cursor += size;
+    result = int8_t(block[cursor++]);
+
+    if (!get_varint(block, cursor, count))
+        return false;
+
+    states = StateListPtr(new std::deque<StateInfo>(1));
+    pos.set(fen, false, &states->back());
+    pliesLeft = int(count);
+
+    return true;
+}
+
+bool TrainingDataReader::next(TrainingEntry& e) {
+
+    while (true)
+    {
+        while (!pliesLeft)
+            if (!start_game())
+                return false;
+
+        uint64_t v;
+
+        if (cursor + 2 > block.size())
+            return false;
+
+        const Move m = Move(get_u16(block.data() + cursor));
+        cursor += 2;
+
+        if (!get_varint(block, cursor, v) || !MoveList<LEGAL>(pos).contains(m))
+            return false;
+
+        const bool recorded = v & 1;
+
+        if (recorded)
+        {
+            e.fen    = pos.fen();
+            e.move   = m;
+            e.score  = Value(unzigzag(v >> 1));
+            e.ply    = pos.game_ply();
+            e.result = pos.side_to_move() == WHITE ? result : -result;
+        }
+
+        states->emplace_back();
+        pos.do_move(m, states->back());
+        --pliesLeft;
+
+        if (recorded)
+            return true;
+    }
+}
+
+// Plays the games. Each worker owns a player searching with a single thread,
+// and writes its games to the file once a whole block is buffered.
+void generate(const GenConfig& config, const OptionsMap& options, Eval::NNUE::EvalFiles& evalFiles) {
+
+    std::ofstream out(config.output, std::ios::binary | std::ios::app);
+    if (!out)
+    {
+        sync_cout << "info string Cannot open " << config.output << sync_endl;
+        return;
+    }
+
+    const Overrides   overrides = {{"Threads", "1"}, {"Hash", std::to_string(config.hash)}};
+    const TimePoint   start     = now();
+    const uint64_t    seed      = config.seed ? config.seed : uint64_t(start) * 6364136223846793005ULL;
+    std::atomic<uint64_t> played{0}, written{0};
+    std::mutex            mutex;
+
+    // Learning would be updated from many games at once
+    const bool wasPaused = LD.is_paused();
+    LD.pause();
+
+    auto flush = [&](std::string& buf, uint64_t& count) {
+        std::lock_guard<std::mutex> lk(mutex);
+
+        std::string header(BlockMagic, 4);
+        put_u32(header, uint32_t(buf.size()));
+        put_u32(header, uint32_t(count));
+        out << header << buf;
+        out.flush();
+
+        written += count;
+        buf.clear();
+        count = 0;
+
+        const TimePoint elapsed = now() - start + 1;
+        sync_cout << "info string gensfen " << written << " positions, "
+                  << written * 1000 / elapsed << " positions/s" << sync_endl;
+    };
+
+    auto worker = [&](int idx) {
+        Player      player(options, overrides, evalFiles);
+        PRNG        rng((seed ^ uint64_t(idx + 1) * 0x9E3779B97F4A7C15ULL) | 1);
+        std::string buf;
+        uint64_t    count = 0;
+
+        // Positions are counted as soon as played, so that the workers do not
+        // overshoot the count by their whole buffers.
+        while (played < config.count)
+        {
+            const uint64_t n = play(player, rng, config, buf);
+            played += n;
+            count += n;
+
+            if (buf.size() >= BlockSize)
+                flush(buf, count);
+        }
+
+        if (!buf.empty())
+            flush(buf, count);
+    };
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < std::max(config.concurrency, 1); ++i)
+        workers.emplace_back(worker, i);
+
+    for (auto& w : workers)
+        w.join();
+
+    if (!wasPaused)
+        LD.resume();
+
+    sync_cout << "info string gensfen finished: " << written << " positions written to "
+              << config.output << sync_endl;
+}
+
+bool convert_to_plain(const std::string& input, const std::string& output) {
+
+    TrainingDataReader reader(input);
+    std::ofstream      out(output);
+
+    if (!reader.is_open() || !out)
+        return false;
+
+    TrainingEntry e;
+    while (reader.next(e))
+        out << "fen " << e.fen << "\nmove " << UCI::move(e.move, false) << "\nscore " << e.score
+            << "\nply " << e.ply << "\nresult " << e.result << "\ne\n";
+
+    return true;
+}
+
+}  // namespace Brainlearn::SelfPlay
@@ -0,0 +1,104 @@
+/*
+  Brainlearn, a UCI chess playing engine derived from Stockfish
+  Copyright (C) 2004-2024 Andrea Manzo, K.Kiniama and Brainlearn developers (see AUTHORS file)
+
+  Brainlearn is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Brainlearn is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef GENSFEN_H_INCLUDED
+#define GENSFEN_H_INCLUDED
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include "../position.h"
+#include "../types.h"
+#include "selfplay.h"
+
+// Training data generation for the NNUE networks. Randomized selfplay games
+// are searched at fixed depth or nodes, and their positions are stored with
+// the search score, the game result and the game ply.
+//
+// The data is written as a sequence of blocks, each block holding whole games:
+//
+//   block  := "MKS2" u32 payloadSize u32 positionCount payload
+//   game   := varint fenSize fen i8 result varint plyCount ply*
+//   ply    := u16 move varint ((zigzag(score) << 1) | recorded)
+//
+// The moves are stored as raw 16-bit moves, so that the files do not depend on
+// the order of the move generator. The result is from White's point of view.
+namespace Brainlearn::SelfPlay {
+
+struct TrainingEntry {
+    std::string fen;
+    Move        move;    // The move played, the best one unless it was random
+    Value       score;   // Search score, from the side to move point of view
+    int         ply;     // Game ply
+    int         result;  // 1, 0 or -1, from the side to move point of view
+};
+
+// Streams the entries of a training data file, one block at a time
+class TrainingDataReader {
+   public:
+    explicit TrainingDataReader(const std::string& file);
+
+    bool is_open() const { return in.is_open(); }
+    bool next(TrainingEntry& e);
+
+   private:
+    bool read_block();
+    bool start_game();
+
+    std::ifstream  in;
+    std::string    block;
+    size_t         cursor = 0;
+    Position       pos;
+    StateListPtr   states;
+    int            pliesLeft = 0;
+    int            result    = 0;
+};
+
+struct GenConfig {
+    uint64_t    count       = 1000000;  // Positions to write, whole games are kept
+    int         concurrency = 1;        // Games played at once, one search thread each
+    int         depth       = 8;
+    uint64_t    nodes       = 0;
+    int         hash        = 16;  // Per game, in MB
+    std::string output      = "training_data.bin";
+
+    // The first moves are randomized: 'randomMoves' random moves are played
+    // within the first 'randomPly' plies of each game.
+    int randomMoves = 8;
+    int randomPly   = 24;
+
+    int      writeMinPly = 16;    // Earlier positions are not written
+    int      evalLimit   = 3000;  // Games are adjudicated past this score
+    uint64_t seed        = 0;
+
+    // Filters
+    bool noChecks   = false;  // Skip positions with the side to move in check
+    bool noCaptures = false;  // Skip positions where the best move is a capture
+    bool quiet      = false;  // Only quiet positions, reached and left by a quiet move
+};
+
+void generate(const GenConfig& config, const OptionsMap& options, Eval::NNUE::EvalFiles& evalFiles);
+
+// Writes the entries of a training data file as plain text, one per line
+bool convert_to_plain(const std::string& input, const std::string& output);
+
+}  // namespace Brainlearn::SelfPlay
+
+#endif  // #ifndef GENSFEN_H_INCLUDED
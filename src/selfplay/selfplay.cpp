@@ -0,0 +1,443 @@
+/*
+  Brainlearn, a UCI chess playing engine derived from Stockfish
+  Copyright (C) 2004-2024 Andrea Manzo, K.Kiniama and Brainlearn developers (see AUTHORS file)
+
+  Brainlearn is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Brainlearn is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "selfplay.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <ctime>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#include "../learn/learn.h"
+#include "../mcts/montecarlo.h"
+#include "../movegen.h"
+#include "../position.h"
+#include "../uci.h"
+
+namespace Brainlearn::SelfPlay {
+
+namespace {
+
+constexpr auto StartFEN = "rnsmksnr/8/pppppppp/8/8/PPPPPPPP/8/RNSKMSNR w 0 1";
+
+// Games still running after this many plies are adjudicated as draws
+constexpr int MaxGamePlies = 800;
+
+// The player whose searches built the process-wide MCTS tree
+const Player* TreeOwner = nullptr;
+
+struct Game {
+    int               round;
+    bool              aIsWhite;
+    std::string       fen;
+    std::vector<Move> moves;
+    GameResult        result;
+    std::string       termination;
+};
+
+// Win, draw and loss counts from the point of view of player A
+struct Score {
+    int wins = 0, draws = 0, losses = 0;
+
+    int    games() const { return wins + draws + losses; }
+    double ratio() const { return (wins + draws / 2.0) / games(); }
+
+    // Variance of the result of a single game
+    double variance() const {
+        const double s = ratio();
+        return (wins * (1 - s) * (1 - s) + draws * (0.5 - s) * (0.5 - s) + losses * s * s)
+             / games();
+    }
+};
+
+// The options of a player: the ones of the main engine with its overrides
+OptionsMap player_options(const OptionsMap& options, const Overrides& overrides) {
+
+    OptionsMap o = options.detached();
+
+    for (const auto& [name, value] : overrides)
+        o[name] = value;
+
+    return o;
+}
+
+double elo(double score) {
+    score = std::clamp(score, 1e-6, 1 - 1e-6);
+    return -400.0 * std::log10(1.0 / score - 1.0);
+}
+
+double expected_score(double elo) { return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0)); }
+
+// Log-likelihood ratio of H1 (elo1) against H0 (elo0), using the normal
+// approximation of the trinomial distribution of the game results.
+double llr(const Score& sc, double elo0, double elo1) {
+
+    const double var = sc.variance();
+    if (!sc.games() || var <= 0)
+        return 0.0;
+
+    const double s0 = expected_score(elo0), s1 = expected_score(elo1);
+    return (s1 - s0) * (2 * sc.ratio() - s0 - s1) / (2 * var) * sc.games();
+}
+
+std::string summary(const Score& sc) {
+
+    std::stringstream ss;
+    const double      sd = std::sqrt(sc.variance() / sc.games());
+    const double      e  = elo(sc.ratio());
+    const double      ci = (elo(sc.ratio() + 1.96 * sd) - elo(sc.ratio() - 1.96 * sd)) / 2;
+    const double      los =
+      sc.wins + sc.losses
+             ? 0.5 * (1 + std::erf((sc.wins - sc.losses) / std::sqrt(2.0 * (sc.wins + sc.losses))))
+             : 0.5;
+
+    ss << "Score of A vs B: " << sc.wins << " - " << sc.losses << " - " << sc.draws << " ["
+       << std::fixed << std::setprecision(3) << sc.ratio() << "] " << sc.games()
+       << "\nElo difference: " << std::setprecision(1) << e << " +/- " << ci
+       << ", LOS: " << 100 * los << " %";
+
+    return ss.str();
+}
+
+// Plays a game from 'fen' and adjudicates it with the Makruk rules, as well as
+// time forfeits and illegal moves.
+void play(Game& game, Player& white, Player& black, const Config& config) {
+
+    StateListPtr states(new std::deque<StateInfo>(1));
+    Position     pos;
+    TimePoint    clock[COLOR_NB] = {config.time, config.time};
+    const bool   timed           = !config.depth && !config.nodes;
+
+    pos.set(game.fen, false, &states->back());
+    white.new_game();
+    black.new_game();
+
+    while (true)
+    {
+        const Color us = pos.side_to_move();
+
+        if (adjudicate(pos, int(game.moves.size()), game.result, game.termination))
+            return;
+
+        Search::LimitsType limits;
+        limits.depth = config.depth;
+        limits.nodes = config.nodes;
+
+        if (timed)
+        {
+            limits.time[WHITE] = clock[WHITE];
+            limits.time[BLACK] = clock[BLACK];
+            limits.inc[WHITE] = limits.inc[BLACK] = config.inc;
+        }
+
+        limits.startTime = now();
+        Move m           = (us == WHITE ? white : black).go(game.fen, game.moves, limits);
+
+        if (timed)
+        {
+            clock[us] -= now() - limits.startTime;
+
+            if (clock[us] < 0)
+            {
+                game.result      = us == WHITE ? BLACK_WINS : WHITE_WINS;
+                game.termination = "time forfeit";
+                return;
+            }
+
+            clock[us] += config.inc;
+        }
+
+        if (!MoveList<LEGAL>(pos).contains(m))
+        {
+            game.result      = us == WHITE ? BLACK_WINS : WHITE_WINS;
+            game.termination = "illegal move";
+            return;
+        }
+
+        game.moves.push_back(m);
+        states->emplace_back();
+        pos.do_move(m, states->back());
+    }
+}
+
+void write_pgn(std::ostream& os, const Game& game, const Config& config, const std::string& date) {
+
+    static constexpr const char* Results[] = {"1-0", "0-1", "1/2-1/2"};
+
+    Position     pos;
+    StateListPtr states(new std::deque<StateInfo>(1));
+    pos.set(game.fen, false, &states->back());
+
+    os << "[Event \"Selfplay\"]\n"
+       << "[Date \"" << date << "\"]\n"
+       << "[Round \"" << game.round << "\"]\n"
+       << "[White \"" << (game.aIsWhite ? "A" : "B") << "\"]\n"
+       << "[Black \"" << (game.aIsWhite ? "B" : "A") << "\"]\n"
+       << "[Result \"" << Results[game.result] << "\"]\n"
+       << "[FEN \"" << game.fen << "\"]\n"
+       << "[SetUp \"1\"]\n"
+       << "[Variant \"makruk\"]\n";
+
+    if (config.depth || config.nodes)
+        os << "[TimeControl \"-\"]\n";
+    else
+        os << "[TimeControl \"" << config.time / 1000.0 << "+" << config.inc / 1000.0 << "\"]\n";
+
+    os << "[PlyCount \"" << game.moves.size() << "\"]\n"
+       << "[Termination \"" << game.termination << "\"]\n\n";
+
+    // Moves are written in coordinate notation, as sent over UCI
+    for (size_t i = 0; i < game.moves.size(); ++i)
+    {
+        if (pos.side_to_move() == WHITE || i == 0)
+            os << 1 + pos.game_ply() / 2 << (pos.side_to_move() == WHITE ? ". " : "... ");
+
+        os << UCI::move(game.moves[i], false) << ((i + 1) % 16 ? " " : "\n");
+
+        states->emplace_back();
+        pos.do_move(game.moves[i], states->back());
+    }
+
+    os << Results[game.result] << "\n\n";
+}
+
+}  // namespace
+
+
+// Reads the positions of an opening file, skipping empty lines and comments
+std::vector<std::string> read_openings(const std::string& file) {
+
+    std::vector<std::string> fens;
+    std::ifstream            in(file);
+    std::string              line;
+
+    while (std::getline(in, line))
+    {
+        // EPD operations follow the position and are not needed
+        line = line.substr(0, line.find(';'));
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+
+        if (!line.empty() && line[0] != '#')
+            fens.push_back(line);
+    }
+
+    return fens;
+}
+
+// Checks whether the game is over: mate, stalemate (a draw), counting rules,
+// 50-move rule, repetition, bare kings or a game too long to be decisive.
+bool adjudicate(const Position& pos, int plies, GameResult& result, std::string& termination) {
+
+    if (!has_any_legal_move(pos))
+    {
+        const Color us = pos.side_to_move();
+        result         = !pos.checkers() ? DRAWN : us == WHITE ? BLACK_WINS : WHITE_WINS;
+        termination    = pos.checkers() ? "checkmate" : "stalemate";
+        return true;
+    }
+
+    if (pos.is_draw(0) || pos.count<ALL_PIECES>() == 2 || plies >= MaxGamePlies)
+    {
+        result      = DRAWN;
+        termination = pos.count<ALL_PIECES>() == 2 ? "insufficient material"
+                    : plies >= MaxGamePlies        ? "adjudication"
+                    : pos.counting_limit() && pos.counting_ply() >= pos.counting_limit()
+                      ? "counting rules"
+                    : pos.rule50_count() > 99 ? "50-move rule"
+                                              : "3-fold repetition";
+        return true;
+    }
+
+    return false;
+}
+
+Player::Player(const OptionsMap& o, const Overrides& overrides, Eval::NNUE::EvalFiles& ef) :
+    options(player_options(o, overrides)),
+    evalFiles(ef) {
+
+    threads.set({bookMan, evalFiles, options, threads, tt});
+}
+
+void Player::new_game() {
+
+    threads.main_thread()->wait_for_search_finished();
+    threads.clear();
+    tt.clear(options["Threads"]);
+}
+
+Move Player::go(const std::string&       fen,
+                const std::vector<Move>& moves,
+                Search::LimitsType       limits,
+                Value*                   value) {
+
+    // The thread pool takes the ownership of the states, so the game is
+    // replayed in a new list, which is cheap compared to the search.
+    StateListPtr states(new std::deque<StateInfo>(1));
+    Position     pos;
+
+    pos.set(fen, false, &states->back());
+
+    for (Move m : moves)
+    {
+        states->emplace_back();
+        pos.do_move(m, states->back());
+    }
+
+    // The players take turns on the MCTS tree, which must not carry the
+    // results of one over to the other.
+    if (options["MCTS"] && TreeOwner != this)
+    {
+        MCTS.clear();
+        TreeOwner = this;
+    }
+
+    limits.silent = true;
+    threads.start_thinking(options, pos, states, limits);
+    threads.main_thread()->wait_for_search_finished();
+
+    if (value)
+        *value = threads.main_manager()->bestValue;
+
+    return threads.main_manager()->bestMove;
+}
+
+
+// Plays the match. Each opening is played twice with the colors reversed, and
+// each concurrent slot owns a pair of players reused from game to game.
+void run(const Config& config, const OptionsMap& options, Eval::NNUE::EvalFiles& evalFiles) {
+
+    std::vector<std::string> openings = config.openings.empty()
+                                        ? std::vector<std::string>{StartFEN}
+                                        : read_openings(config.openings);
+    if (openings.empty())
+    {
+        sync_cout << "info string No openings found in " << config.openings << sync_endl;
+        return;
+    }
+
+    // The MCTS tree and its settings are process-wide, so the games of MCTS
+    // players cannot run concurrently.
+    if (config.concurrency > 1
+        && (player_options(options, config.options[0])["MCTS"]
+            || player_options(options, config.options[1])["MCTS"]))
+    {
+        sync_cout << "info string MCTS players cannot play concurrently, use concurrency 1"
+                  << sync_endl;
+        return;
+    }
+
+    TreeOwner = nullptr;
+
+    char              date[16];
+    const std::time_t t = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y.%m.%d", std::localtime(&t));
+
+    std::ofstream pgn;
+    if (!config.pgn.empty())
+        pgn.open(config.pgn, std::ios::app);
+
+    const double lower = std::log(config.beta / (1 - config.alpha));
+    const double upper = std::log((1 - config.beta) / config.alpha);
+
+    std::atomic<int>  next{0};
+    std::atomic<bool> stop{false};
+    std::mutex        mutex;
+    Score             score;
+
+    // Learning would be updated from many games at once
+    const bool wasPaused = LD.is_paused();
+    LD.pause();
+
+    auto worker = [&] {
+        Player a(options, config.options[0], evalFiles);
+        Player b(options, config.options[1], evalFiles);
+
+        for (int idx; !stop && (idx = next++) < config.games;)
+        {
+            Game game;
+            game.round    = idx + 1;
+            game.aIsWhite = idx % 2 == 0;
+            game.fen      = openings[idx / 2 % openings.size()];
+
+            play(game, game.aIsWhite ? a : b, game.aIsWhite ? b : a, config);
+
+            std::lock_guard<std::mutex> lk(mutex);
+
+            if (game.result == DRAWN)
+                score.draws++;
+            else if ((game.result == WHITE_WINS) == game.aIsWhite)
+                score.wins++;
+            else
+                score.losses++;
+
+            if (pgn.is_open())
+                write_pgn(pgn, game, config, date), pgn.flush();
+
+            sync_cout << "info string Finished game " << game.round << " ("
+                      << (game.aIsWhite ? "A vs B" : "B vs A") << "): "
+                      << (game.result == WHITE_WINS   ? "1-0"
+                          : game.result == BLACK_WINS ? "0-1"
+                                                      : "1/2-1/2")
+                      << " {" << game.termination << "}\n"
+                      << summary(score) << sync_endl;
+
+            if (config.sprt)
+            {
+                const double r = llr(score, config.elo0, config.elo1);
+                if (r <= lower || r >= upper)
+                {
+                    sync_cout << "info string SPRT: " << (r >= upper ? "H1" : "H0")
+                              << " was accepted" << sync_endl;
+                    stop = true;
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < std::max(config.concurrency, 1); ++i)
+        workers.emplace_back(worker);
+
+    for (auto& w : workers)
+        w.join();
+
+    if (!wasPaused)
+        LD.resume();
+
+    if (!score.games())
+        return;
+
+    std::stringstream ss;
+    ss << summary(score);
+
+    if (config.sprt)
+        ss << "\nSPRT: llr " << std::fixed << std::setprecision(2)
+           << llr(score, config.elo0, config.elo1) << " (" << lower << ", " << upper
+           << "), elo0 " << config.elo0 << ", elo1 " << config.elo1;
+
+    sync_cout << ss.str() << sync_endl;
+}
+
+}  // namespace Brainlearn::SelfPlay
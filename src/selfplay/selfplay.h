@@ -0,0 +1,99 @@
+/*
+  Brainlearn, a UCI chess playing engine derived from Stockfish
+  Copyright (C) 2004-2024 Andrea Manzo, K.Kiniama and Brainlearn developers (see AUTHORS file)
+
+  Brainlearn is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Brainlearn is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SELFPLAY_H_INCLUDED
+#define SELFPLAY_H_INCLUDED
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../evaluate.h"
+#include "../misc.h"
+#include "../search.h"
+#include "../thread.h"
+#include "../tt.h"
+#include "../types.h"
+#include "../ucioption.h"
+#include "../book/book_manager.h"
+
+// In-process games between engine instances. Every game runs its own pair of
+// players, so that many games can be played concurrently without any GUI.
+namespace Brainlearn::SelfPlay {
+
+enum GameResult {
+    WHITE_WINS,
+    BLACK_WINS,
+    DRAWN
+};
+
+// Option values that differ from the ones of the main engine, as (name, value)
+using Overrides = std::vector<std::pair<std::string, std::string>>;
+
+// An engine instance with its own options, threads and transposition table.
+// The networks are shared with the main engine since they are loaded globally.
+class Player {
+   public:
+    Player(const OptionsMap& options, const Overrides& overrides, Eval::NNUE::EvalFiles& ef);
+
+    void new_game();
+
+    // Searches the position reached from 'fen' after 'moves' and returns the
+    // best move, storing its score from the side to move point of view.
+    Move go(const std::string&       fen,
+            const std::vector<Move>& moves,
+            Search::LimitsType       limits,
+            Value*                   value = nullptr);
+
+   private:
+    OptionsMap             options;
+    Eval::NNUE::EvalFiles& evalFiles;
+    BookManager            bookMan;
+    TranspositionTable     tt;
+    ThreadPool             threads;  // Last, so that it is destroyed first
+};
+
+struct Config {
+    int         games       = 100;
+    int         concurrency = 1;
+    TimePoint   time        = 10000;  // Base time and increment in milliseconds
+    TimePoint   inc         = 100;
+    int         depth       = 0;
+    uint64_t    nodes       = 0;
+    std::string openings;  // FEN/EPD file, one position per line
+    std::string pgn;       // Output file, games are appended as they finish
+    Overrides   options[2];
+
+    // SPRT stops the match as soon as one of the hypotheses is accepted
+    bool   sprt  = false;
+    double elo0  = 0.0;
+    double elo1  = 5.0;
+    double alpha = 0.05;
+    double beta  = 0.05;
+};
+
+std::vector<std::string> read_openings(const std::string& file);
+
+bool adjudicate(const Position& pos, int plies, GameResult& result, std::string& termination);
+
+void run(const Config& config, const OptionsMap& options, Eval::NNUE::EvalFiles& evalFiles);
+
+}  // namespace Brainlearn::SelfPlay
+
+#endif  // #ifndef SELFPLAY_H_INCLUDED
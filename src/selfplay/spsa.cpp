@@ -0,0 +1,510 @@
+/*
+  Brainlearn, a UCI chess playing engine derived from Stockfish
+  Copyright (C) 2004-2024 Andrea Manzo, K.Kiniama and Brainlearn developers (see AUTHORS file)
+
+  Brainlearn is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Brainlearn is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "spsa.h"
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+    #include <csignal>
+    #include <fcntl.h>
+    #include <sys/wait.h>
+    #include <unistd.h>
+#endif
+
+#include "../movegen.h"
+#include "../position.h"
+#include "../tune.h"
+#include "../uci.h"
+
+namespace Brainlearn::SelfPlay {
+
+#ifndef _WIN32
+
+namespace {
+
+constexpr auto StartFEN = "rnsmksnr/8/pppppppp/8/8/PPPPPPPP/8/RNSKMSNR w 0 1";
+
+// A child engine process, driven through UCI over a pair of pipes
+class Engine {
+   public:
+    explicit Engine(const std::string& binary);
+    ~Engine();
+
+    bool is_running() const { return pid > 0; }
+    void send(const std::string& cmd);
+    bool read_line(std::string& line);
+
+    // Reads lines until one starts with 'token', returning it in 'line'
+    bool wait_for(const std::string& token, std::string& line);
+
+   private:
+    pid_t       pid = -1;
+    int         in = -1, out = -1;
+    std::string buffer;
+};
+
+// Pipes are created and made close-on-exec under a lock, so that an engine
+// started from another thread cannot inherit them and keep them open.
+std::mutex SpawnMutex;
+
+Engine::Engine(const std::string& binary) {
+
+    std::lock_guard<std::mutex> lk(SpawnMutex);
+
+    int toChild[2], fromChild[2];
+
+    if (pipe(toChild))
+        return;
+
+    if (pipe(fromChild))
+    {
+        close(toChild[0]), close(toChild[1]);
+        return;
+    }
+
+    for (int fd : {toChild[0], toChild[1], fromChild[0], fromChild[1]})
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+    const char* path = binary.c_str();
+
+    if ((pid = fork()) == 0)
+    {
+        dup2(toChild[0], STDIN_FILENO);
+        dup2(fromChild[1], STDOUT_FILENO);
+        execlp(path, path, nullptr);
+        _exit(1);
+    }
+
+    close(toChild[0]);
+    close(fromChild[1]);
+    in  = toChild[1];
+    out = fromChild[0];
+}
+
+Engine::~Engine() {
+
+    if (!is_running())
+        return;
+
+    send("quit");
+    close(in);
+    close(out);
+    waitpid(pid, nullptr, 0);
+}
+
+void Engine::send(const std::string& cmd) {
+
+    const std::string s = cmd + "\n";
+
+    for (size_t done = 0; done < s.size();)
+    {
+        const ssize_t n = write(in, s.data() + done, s.size() - done);
+        if (n <= 0)
+            return;
+        done += size_t(n);
+    }
+}
+
+bool Engine::read_line(std::string& line) {
+
+    size_t nl;
+    char   buf[4096];
+
+    while ((nl = buffer.find('\n')) == std::string::npos)
+    {
+        const ssize_t n = read(out, buf, sizeof(buf));
+        if (n <= 0)
+            return false;
+        buffer.append(buf, size_t(n));
+    }
+
+    line = buffer.substr(0, nl);
+    buffer.erase(0, nl + 1);
+
+    if (!line.empty() && line.back() == '\r')
+        line.pop_back();
+
+    return true;
+}
+
+bool Engine::wait_for(const std::string& token, std::string& line) {
+
+    while (read_line(line))
+        if (line.compare(0, token.size(), token) == 0)
+            return true;
+
+    return false;
+}
+
+// Current estimate of a parameter, kept in floating point between iterations
+struct Theta {
+    std::string name;
+    double      value;
+    int         min, max;
+    double      c, a;  // Scale of the perturbation and of the step, see SpsaConfig
+};
+
+// Plays a game from 'fen' after the 'opening' moves, with engines[0] playing
+// White. Returns false if an engine stopped responding.
+bool play(Engine*                         engines[COLOR_NB],
+          const std::string&              fen,
+          const std::vector<std::string>& opening,
+          const SpsaConfig&               config,
+          GameResult&                     result) {
+
+    StateListPtr             states(new std::deque<StateInfo>(1));
+    Position                 pos;
+    std::vector<std::string> moves;
+    TimePoint                clock[COLOR_NB] = {config.time, config.time};
+    const bool               timed           = !config.depth && !config.nodes;
+    std::string              termination, line;
+
+    pos.set(fen, false, &states->back());
+
+    for (Engine* e : {engines[WHITE], engines[BLACK]})
+    {
+        e->send("ucinewgame");
+        e->send("isready");
+        if (!e->wait_for("readyok", line))
+            return false;
+    }
+
+    for (std::string m : opening)
+    {
+        states->emplace_back();
+        pos.do_move(UCI::to_move(pos, m), states->back());
+        moves.push_back(m);
+    }
+
+    while (!adjudicate(pos, int(moves.size()), result, termination))
+    {
+        const Color us  = pos.side_to_move();
+        Engine*     e   = engines[us];
+        std::string cmd = "position fen " + fen + " moves";
+
+        for (const auto& m : moves)
+            cmd += " " + m;
+
+        e->send(cmd);
+
+        if (config.depth)
+            e->send("go depth " + std::to_string(config.depth));
+        else if (config.nodes)
+            e->send("go nodes " + std::to_string(config.nodes));
+        else
+            e->send("go wtime " + std::to_string(clock[WHITE]) + " btime "
+                    + std::to_string(clock[BLACK]) + " winc " + std::to_string(config.inc)
+                    + " binc " + std::to_string(config.inc));
+
+        const TimePoint start = now();
+
+        if (!e->wait_for("bestmove", line))
+            return false;
+
+        if (timed)
+        {
+            clock[us] -= now() - start;
+
+            if (clock[us] < 0)
+            {
+                result = us == WHITE ? BLACK_WINS : WHITE_WINS;
+                return true;
+            }
+
+            clock[us] += config.inc;
+        }
+
+        std::istringstream is(line);
+        std::string        token;
+        is >> token >> token;
+
+        const Move m = UCI::to_move(pos, token);
+
+        if (m == Move::none())
+        {
+            result = us == WHITE ? BLACK_WINS : WHITE_WINS;
+            return true;
+        }
+
+        moves.push_back(token);
+        states->emplace_back();
+        pos.do_move(m, states->back());
+    }
+
+    return true;
+}
+
+// Picks the opening of a game pair: a position of the book, if any, followed
+// by random legal moves that do not end the game.
+void pick_opening(const std::vector<std::string>& book,
+                  int                             randomPly,
+                  PRNG&                           rng,
+                  std::string&                    fen,
+                  std::vector<std::string>&       moves) {
+
+    while (true)
+    {
+        StateListPtr states(new std::deque<StateInfo>(1));
+        Position     pos;
+        GameResult   result;
+        std::string  termination;
+
+        fen = book.empty() ? StartFEN : book[rng.rand<uint64_t>() % book.size()];
+        moves.clear();
+        pos.set(fen, false, &states->back());
+
+        for (int i = 0; i < randomPly && !adjudicate(pos, i, result, termination); ++i)
+        {
+            MoveList<LEGAL> legal(pos);
+            const Move      m = *(legal.begin() + rng.rand<uint64_t>() % legal.size());
+
+            moves.push_back(UCI::move(m, false));
+            states->emplace_back();
+            pos.do_move(m, states->back());
+        }
+
+        if (!adjudicate(pos, int(moves.size()), result, termination))
+            return;
+    }
+}
+
+void save(const std::string& file, int iteration, const std::vector<Theta>& theta) {
+
+    std::ofstream out(file);
+
+    out << "iteration " << iteration << "\n" << std::setprecision(10);
+
+    for (const auto& t : theta)
+        out << t.name << " " << t.value << "\n";
+}
+
+bool load(const std::string& file, int& iteration, std::vector<Theta>& theta) {
+
+    std::ifstream in(file);
+    std::string   token, name;
+    double        value;
+
+    if (!(in >> token >> iteration) || token != "iteration")
+        return false;
+
+    while (in >> name >> value)
+        for (auto& t : theta)
+            if (t.name == name)
+                t.value = std::clamp(value, double(t.min), double(t.max));
+
+    return true;
+}
+
+}  // namespace
+
+
+// Runs the tuning session. Iterations are handed out to the concurrent slots as
+// soon as they are free, and each one reads the latest parameters, so that the
+// updates of the other slots are used as they come, as fishtest does.
+void spsa(const SpsaConfig& config, const std::string& binary) {
+
+    const auto params = Tune::parameters();
+
+    if (params.empty())
+    {
+        sync_cout << "info string No parameters to tune, see TUNE() in tune.h" << sync_endl;
+        return;
+    }
+
+    const std::vector<std::string> book =
+      config.openings.empty() ? std::vector<std::string>() : read_openings(config.openings);
+
+    if (!config.openings.empty() && book.empty())
+    {
+        sync_cout << "info string No openings found in " << config.openings << sync_endl;
+        return;
+    }
+
+    const int    N = config.iterations;
+    const double A = config.A >= 0 ? config.A : 0.1 * N;
+
+    std::vector<Theta> theta;
+    for (const auto& p : params)
+    {
+        const double cEnd = (p.range.second - p.range.first) / 20.0;
+        const double aEnd = config.rEnd * cEnd * cEnd;
+
+        theta.push_back({p.name, double(p.value), p.range.first, p.range.second,
+                         cEnd * std::pow(N, config.gamma), aEnd * std::pow(A + N, config.alpha)});
+    }
+
+    int started = 0, done = 0;
+
+    if (config.resume && load(config.checkpoint, done, theta))
+        sync_cout << "info string Resuming from iteration " << done << " of "
+                  << config.checkpoint << sync_endl;
+
+    started = done;
+
+    std::mutex mutex;
+    bool       failed = false;
+
+    // A child process that exits would kill us on the next write
+    const auto oldHandler = std::signal(SIGPIPE, SIG_IGN);
+
+    auto worker = [&](int idx) {
+        // engines[0] plays with theta + c_k * delta, engines[1] with theta - c_k * delta
+        Engine      plus(binary), minus(binary);
+        PRNG        rng((uint64_t(now()) * 6364136223846793005ULL ^ uint64_t(idx + 1) << 32) | 1);
+        std::string line;
+
+        for (Engine* e : {&plus, &minus})
+        {
+            e->send("uci");
+            if (!e->is_running() || !e->wait_for("uciok", line))
+            {
+                std::lock_guard<std::mutex> lk(mutex);
+                failed = true;
+                return;
+            }
+
+            e->send("setoption name Threads value 1");
+            e->send("setoption name Hash value " + std::to_string(config.hash));
+            e->send("setoption name Read only learning value true");
+
+            for (const auto& [name, value] : config.options)
+                e->send("setoption name " + name + " value " + value);
+        }
+
+        while (true)
+        {
+            std::vector<int>         delta(theta.size());
+            std::vector<double>      ck(theta.size());
+            std::string              fen;
+            std::vector<std::string> opening;
+            int                      k;
+
+            {
+                std::lock_guard<std::mutex> lk(mutex);
+
+                if (failed || started >= N)
+                    return;
+
+                k = ++started;
+
+                for (size_t i = 0; i < theta.size(); ++i)
+                {
+                    delta[i] = rng.rand<uint64_t>() & 1 ? 1 : -1;
+                    ck[i]    = theta[i].c / std::pow(k, config.gamma);
+                }
+
+                for (size_t i = 0; i < theta.size(); ++i)
+                    for (Engine* e : {&plus, &minus})
+                    {
+                        const auto&  t = theta[i];
+                        const double v = t.value + (e == &plus ? 1 : -1) * ck[i] * delta[i];
+
+                        e->send("setoption name " + t.name + " value "
+                                + std::to_string(std::lround(
+                                  std::clamp(v, double(t.min), double(t.max)))));
+                    }
+            }
+
+            pick_opening(book, config.randomPly, rng, fen, opening);
+
+            // The pair shares its opening, with the colors reversed
+            Engine*    firstGame[COLOR_NB]  = {&plus, &minus};
+            Engine*    secondGame[COLOR_NB] = {&minus, &plus};
+            GameResult r1, r2;
+
+            const bool ok = play(firstGame, fen, opening, config, r1)
+                         && play(secondGame, fen, opening, config, r2);
+
+            std::lock_guard<std::mutex> lk(mutex);
+
+            if (!ok)
+            {
+                failed = true;
+                return;
+            }
+
+            // Result of the pair from the point of view of the plus engine, in [-2, 2]
+            const int result = (r1 == WHITE_WINS) - (r1 == BLACK_WINS) + (r2 == BLACK_WINS)
+                             - (r2 == WHITE_WINS);
+
+            for (size_t i = 0; i < theta.size(); ++i)
+            {
+                auto&        t  = theta[i];
+                const double ak = t.a / std::pow(A + k, config.alpha);
+
+                t.value = std::clamp(t.value + ak * result / (ck[i] * delta[i]), double(t.min),
+                                     double(t.max));
+            }
+
+            if (++done % std::max(config.interval, 1) == 0)
+            {
+                save(config.checkpoint, done, theta);
+
+                std::stringstream ss;
+                ss << "info string SPSA iteration " << done << "/" << N;
+                for (const auto& t : theta)
+                    ss << "\n" << t.name << " " << std::fixed << std::setprecision(2) << t.value;
+
+                sync_cout << ss.str() << sync_endl;
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < std::max(config.concurrency, 1); ++i)
+        workers.emplace_back(worker, i);
+
+    for (auto& w : workers)
+        w.join();
+
+    std::signal(SIGPIPE, oldHandler);
+
+    save(config.checkpoint, done, theta);
+
+    if (failed)
+        sync_cout << "info string SPSA stopped: an engine running " << binary
+                  << " stopped responding" << sync_endl;
+
+    // The final values, ready to be pasted in Tune::read_results()
+    std::stringstream ss;
+    ss << "info string SPSA finished after " << done << " iterations";
+    for (const auto& t : theta)
+        ss << "\n  TuneResults[\"" << t.name << "\"] = " << std::lround(t.value) << ";";
+
+    sync_cout << ss.str() << sync_endl;
+}
+
+#else
+
+void spsa(const SpsaConfig&, const std::string&) {
+    sync_cout << "info string SPSA is not supported on this platform" << sync_endl;
+}
+
+#endif
+
+}  // namespace Brainlearn::SelfPlay
@@ -0,0 +1,68 @@
+/*
+  Brainlearn, a UCI chess playing engine derived from Stockfish
+  Copyright (C) 2004-2024 Andrea Manzo, K.Kiniama and Brainlearn developers (see AUTHORS file)
+
+  Brainlearn is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Brainlearn is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SPSA_H_INCLUDED
+#define SPSA_H_INCLUDED
+
+#include <cstdint>
+#include <string>
+
+#include "../misc.h"
+#include "selfplay.h"
+
+// A local SPSA driver for the parameters registered with TUNE(). Each
+// iteration perturbs all the parameters at once, plays a pair of games between
+// the two perturbed engines and moves the parameters towards the winner, as
+// fishtest does.
+//
+// The tuned parameters are globals read by the search, so the two sides cannot
+// share a process: every concurrent slot drives two child processes of this
+// same binary through UCI, setting their values with 'setoption'.
+namespace Brainlearn::SelfPlay {
+
+struct SpsaConfig {
+    int       iterations  = 1000;  // Game pairs
+    int       concurrency = 1;     // Game pairs played at once, two engines each
+    TimePoint time        = 10000;  // Base time and increment in milliseconds
+    TimePoint inc         = 100;
+    int       depth       = 0;
+    uint64_t  nodes       = 0;
+    int       hash        = 16;
+    int       randomPly   = 8;  // Random plies of the opening shared by a pair
+    std::string openings;        // FEN/EPD file, one position per line
+    Overrides   options;         // Applied to both engines
+
+    // Progress is saved every 'interval' iterations, and loaded back on 'resume'
+    std::string checkpoint = "spsa.txt";
+    int         interval   = 50;
+    bool        resume     = false;
+
+    // Gain sequences a_k = a / (A + k)^alpha and c_k = c / k^gamma, where c and
+    // a follow from the final perturbation c_end = (max - min) / 20 and the
+    // final learning rate r_end = a_end / c_end^2 of each parameter.
+    double alpha = 0.602;
+    double gamma = 0.101;
+    double A     = -1;  // Defaults to 10% of the iterations
+    double rEnd  = 0.002;
+};
+
+void spsa(const SpsaConfig& config, const std::string& binary);
+
+}  // namespace Brainlearn::SelfPlay
+
+#endif  // #ifndef SPSA_H_INCLUDED
@@ -25,15 +25,21 @@
 #include <unordered_map>
 #include <utility>
 #include <array>
+#include <cmath>
+#include <string>
 
+#include "memory.h"
 #include "misc.h"
 #include "movegen.h"
 #include "search.h"
-// #include "syzygy/tbprobe.h"
+#include "bitbase/bitbase.h"
+#include "analysis/analysis.h"
 #include "timeman.h"
 #include "tt.h"
 #include "types.h"
+#include "uci.h"
 #include "ucioption.h"
+#include "learn/learn.h"
 
 namespace Brainlearn {
 
@@ -48,6 +54,8 @@ Thread::Thread(Search::SharedState&                    sharedState,
     nthreads(sharedState.options["Threads"]),
     stdThread(&Thread::idle_loop, this) {
 
+    Memory::track(Memory::WORKERS, worker.get(), sizeof(Search::Worker));
+
     wait_for_search_finished();
 }
 
@@ -58,6 +66,8 @@ Thread::~Thread() {
 
     assert(!searching);
 
+    Memory::untrack(worker.get());
+
     exit = true;
     start_searching();
     stdThread.join();
@@ -65,9 +75,18 @@ Thread::~Thread() {
 
 // Wakes up the thread that will start the search
 void Thread::start_searching() {
-    mutex.lock();
-    searching = true;
-    mutex.unlock();   // Unlock before notifying saves a few CPU-cycles
+    run_custom_job([this]() { worker->start_searching(); });
+}
+
+// Wakes up the thread to run the given function instead of a search, for
+// instance to initialize the memory of its worker from the thread using it.
+void Thread::run_custom_job(std::function<void()> f) {
+    {
+        std::unique_lock<std::mutex> lk(mutex);
+        cv.wait(lk, [&] { return !searching; });
+        jobFunc   = std::move(f);
+        searching = true;
+    }
     cv.notify_one();  // Wake up the thread in idle_loop()
 }
 
@@ -104,32 +123,41 @@ void Thread::idle_loop() {
         if (exit)
             return;
 
+        std::function<void()> job = std::move(jobFunc);
+        jobFunc                   = nullptr;
+
         lk.unlock();
 
-        worker->start_searching();
+        if (job)
+            job();
     }
 }
 
 // Creates/destroys threads to match the requested number.
 // Created and launched threads will immediately go to sleep in idle_loop.
-// Upon resizing, threads are recreated to allow for binding if necessary.
+// The threads that are kept are not recreated, unless the pool crosses the
+// size above which threads bind themselves to a processor group when they
+// start. The hash is reallocated only if its size changed.
 void ThreadPool::set(Search::SharedState sharedState) {
 
-    if (threads.size() > 0)  // destroy any existing thread(s)
+    const size_t requested = sharedState.options["Threads"];
+
+    if (threads.size() > 0)
     {
         main_thread()->wait_for_search_finished();
 
-        while (threads.size() > 0)
+        const size_t keep = (threads.size() > 8) == (requested > 8) ? requested : 0;
+
+        while (threads.size() > keep)
             delete threads.back(), threads.pop_back();
     }
 
-    const size_t requested = sharedState.options["Threads"];
-
     if (requested > 0)  // create new thread(s)
     {
-        threads.push_back(new Thread(
-          sharedState, std::unique_ptr<Search::ISearchManager>(new Search::SearchManager()), 0));
-
+        if (threads.empty())
+            threads.push_back(new Thread(
+              sharedState, std::unique_ptr<Search::ISearchManager>(new Search::SearchManager()),
+              0));
 
         while (threads.size() < requested)
             threads.push_back(new Thread(
@@ -137,19 +165,21 @@ void ThreadPool::set(Search::SharedState sharedState) {
               threads.size()));
         clear();
 
-        main_thread()->wait_for_search_finished();
-
-        // Reallocate the hash with the new threadpool size
-        sharedState.tt.resize(sharedState.options["Hash"], requested);
+        if (!sharedState.tt.has_size(sharedState.options["Hash"]))
+            sharedState.tt.resize(sharedState.options["Hash"], requested);
     }
 }
 
 
-// Sets threadPool data to initial values
+// Sets threadPool data to initial values. Every thread clears its own worker,
+// all at once, which also places the memory of new workers near the thread.
 void ThreadPool::clear() {
 
     for (Thread* th : threads)
-        th->worker->clear();
+        th->run_custom_job([th]() { th->worker->clear(); });
+
+    for (Thread* th : threads)
+        th->wait_for_search_finished();
 
     main_manager()->callsCnt                 = 0;
     main_manager()->bestPreviousScore        = VALUE_INFINITE;
@@ -174,14 +204,41 @@ void ThreadPool::start_thinking(const OptionsMap&  options,
 
     increaseDepth = true;
 
-    Search::RootMoves rootMoves;
+    rootMoves.clear();
 
     for (const auto& m : MoveList<LEGAL>(pos))
         if (limits.searchmoves.empty()
             || std::count(limits.searchmoves.begin(), limits.searchmoves.end(), m))
             rootMoves.emplace_back(m);
 
-    // Tablebases::Config tbConfig = Tablebases::rank_root_moves(options, pos, rootMoves);
+    tbConfig = Bitbases::rank_root_moves(options, pos, rootMoves);
+
+    // If the last search was pondering and the opponent played one of the
+    // replies searched then, either after a 'stop' or without 'ponderhit', we
+    // go on from the deepest iteration completed on it instead of restarting.
+    // Likewise for a position found deeper in the analysis cache.
+    Depth startDepth = 0;
+
+    if (pondering && limits.searchmoves.empty())
+        for (Thread* th : threads)
+            if (th->worker->rootPos.key() == pos.key()
+                && th->worker->rootMoves.size() == rootMoves.size()
+                && th->worker->completedDepth > startDepth)
+            {
+                startDepth = th->worker->completedDepth;
+                rootMoves  = th->worker->rootMoves;
+            }
+
+    if (startDepth && !limits.silent)
+        sync_cout << "info string ponder hit, resuming at depth " << startDepth + 1 << sync_endl;
+
+    if (!limits.silent && limits.searchmoves.empty() && !tbConfig.rootInTB)
+        if (Depth d = Analysis::probe(pos, options, rootMoves, startDepth))
+        {
+            startDepth = d;
+            sync_cout << "info string analysis cache hit, resuming at depth " << startDepth + 1
+                      << sync_endl;
+        }
 
     // After ownership transfer 'states' becomes empty, so if we stop the search
     // and call 'go' again without setting a new position states.get() == nullptr.
@@ -190,6 +247,10 @@ void ThreadPool::start_thinking(const OptionsMap&  options,
     if (states.get())
         setupStates = std::move(states);  // Ownership transfer, states is now empty
 
+    rootFen     = pos.fen();
+    pondering   = ponderMode;
+    ponderSplit = size();
+
     // We use Position::set() to set root position across threads. But there are
     // some StateInfo fields (previous, pliesFromNull, capturedPiece) that cannot
     // be deduced from a fen string, so set() clears them and they are set from
@@ -200,17 +261,217 @@ void ThreadPool::start_thinking(const OptionsMap&  options,
         th->worker->limits = limits;
         th->worker->nodes = th->worker->tbHits = th->worker->nmpMinPly =
           th->worker->bestMoveChanges          = 0;
-        th->worker->rootDepth = th->worker->completedDepth = 0;
+        th->worker->rootDepth = th->worker->completedDepth = startDepth;
         th->worker->rootMoves                              = rootMoves;
-        th->worker->rootPos.set(pos.fen(), pos.is_chess960(), &th->worker->rootState);
-        th->worker->rootState = setupStates->back();
-        // th->worker->tbConfig  = tbConfig;
-        th->worker->effort    = {};
+        th->worker->rootPos.set(rootFen, pos.is_chess960(), &th->worker->rootState);
+        th->worker->rootState   = setupStates->back();
+        th->worker->tbConfig    = tbConfig;
+        th->worker->effort      = {};
+        th->worker->ponderGroup = 0;
+        th->worker->detached    = false;
     }
 
+    if (ponderMode)
+        split_ponder(options, pos, limits);
+
     main_thread()->start_searching();
 }
 
+// Splits the pool across the likely replies of the opponent when pondering.
+// The position before the expected reply is taken back, its other replies are
+// scored from the experience file and the transposition table, and the best
+// ones get a share of the threads in proportion to their estimated probability.
+// The expected reply keeps the main thread and the rest of the pool.
+void ThreadPool::split_ponder(const OptionsMap&         options,
+                              Position&                 pos,
+                              const Search::LimitsType& limits) {
+
+    constexpr double Temperature = NormalizeToPawnValue / 2;
+    constexpr double MinWeight   = 0.1;
+
+    const size_t candidates = std::min(size_t(int(options["Ponder Candidates"])), size());
+    const Move   expected   = limits.ponderMove;
+
+    if (candidates < 2 || !expected.is_ok() || !limits.searchmoves.empty()
+        || setupStates->size() < 2)
+        return;
+
+    struct Reply {
+        Move   move;
+        Value  score;
+        Depth  depth;
+        double weight;
+    };
+
+    const TranspositionTable& tt = main_thread()->worker->tt;
+    std::vector<Reply>        replies;
+    Value                     best = -VALUE_INFINITE;
+    StateInfo                 st;
+
+    pos.undo_move(expected);
+
+    const std::string fen = pos.fen();
+
+    // Scores are from the point of view of the opponent
+    for (const auto& m : MoveList<LEGAL>(pos))
+    {
+        Reply r{m, VALUE_NONE, DEPTH_NONE, 0};
+
+        if (LD.is_enabled())
+            if (const LearningMove* lm = LD.probe_move(pos.key(), m); lm && lm->score != VALUE_NONE)
+                r.score = lm->score, r.depth = lm->depth;
+
+        bool found;
+        pos.do_move(m, st);
+        const TTEntry* tte = tt.probe(pos.key(), found);
+        if (found && tte->value() != VALUE_NONE && tte->depth() > r.depth)
+            r.score = -tte->value(), r.depth = tte->depth();
+        pos.undo_move(m);
+
+        if (r.score == VALUE_NONE)
+            continue;
+
+        best = std::max(best, r.score);
+
+        if (m != expected)
+            replies.push_back(r);
+    }
+
+    pos.do_move(expected, setupStates->back());
+
+    // The expected reply is the reference, with a weight of 1
+    double total = 1;
+
+    for (Reply& r : replies)
+        r.weight = std::exp((r.score - best) / Temperature);
+
+    std::stable_sort(replies.begin(), replies.end(),
+                     [](const Reply& a, const Reply& b) { return a.weight > b.weight; });
+
+    replies.erase(std::find_if(replies.begin(), replies.end(),
+                               [&](const Reply& r) { return r.weight < MinWeight; }),
+                  replies.end());
+
+    replies.resize(std::min(replies.size(), candidates - 1));
+
+    for (const Reply& r : replies)
+        total += r.weight;
+
+    // Threads are taken from the end of the pool, so the expected reply keeps
+    // the main thread and at least its own share.
+    const size_t expectedThreads = std::max(size_t(1), size_t(size() / total));
+    std::string  info;
+
+    for (size_t group = 1; group <= replies.size(); ++group)
+    {
+        const Reply& r = replies[group - 1];
+        const size_t n = std::max(size_t(1), size_t(size() * r.weight / total));
+
+        if (ponderSplit < expectedThreads + n)
+            break;
+
+        ponderSplit -= n;
+
+        for (size_t i = ponderSplit; i < ponderSplit + n; ++i)
+        {
+            Search::Worker& w = *threads[i]->worker;
+
+            w.ponderGroup = group;
+            w.rootPos.set(fen, pos.is_chess960(), &w.rootState);
+            w.rootState = (*setupStates)[setupStates->size() - 2];
+            w.rootPos.do_move(r.move, w.ponderState);
+
+            if (i == ponderSplit)
+            {
+                w.rootMoves.clear();
+                for (const auto& m : MoveList<LEGAL>(w.rootPos))
+                    w.rootMoves.emplace_back(m);
+                w.tbConfig = Bitbases::rank_root_moves(options, w.rootPos, w.rootMoves);
+            }
+            else
+            {
+                w.rootMoves = threads[ponderSplit]->worker->rootMoves;
+                w.tbConfig  = threads[ponderSplit]->worker->tbConfig;
+            }
+        }
+
+        info += ", " + UCI::move(r.move, pos.is_chess960()) + " "
+              + std::to_string(int(100 * r.weight / total)) + "% " + std::to_string(n)
+              + " threads";
+    }
+
+    if (ponderSplit < size() && !limits.silent)
+        sync_cout << "info string ponder " << UCI::move(expected, pos.is_chess960()) << " "
+                  << int(100 / total) << "% " << ponderSplit << " threads" << info
+                  << sync_endl;
+}
+
+// The GUI played the expected move: switch from pondering to the normal search,
+// and detach the threads that pondered on other replies so that they join it.
+void ThreadPool::ponderhit() {
+
+    for (size_t i = ponderSplit; i < size(); ++i)
+        threads[i]->worker->detached = true;
+
+    pondering              = false;
+    main_manager()->ponder = false;
+}
+
+// Called by a detached thread to move to the root of the main search
+void ThreadPool::join_main_search(Search::Worker& w) {
+
+    w.rootPos.set(rootFen, w.rootPos.is_chess960(), &w.rootState);
+    w.rootState   = setupStates->back();
+    w.rootMoves   = rootMoves;
+    w.tbConfig    = tbConfig;
+    w.rootDepth   = w.completedDepth = 0;
+    w.ponderGroup = 0;
+    w.detached    = false;
+}
+
+// Called by the main thread before the search, when MCTS is enabled. With the
+// dynamic split and at least 3 threads one helper starts, and stays, on each
+// side. With 2 threads the only helper runs MCTS for the whole search and the
+// main thread is the alpha-beta side, so nothing can be rebalanced.
+void ThreadPool::init_mcts(size_t quota, bool dynamic) {
+
+    mctsQuota     = dynamic && size() >= 3 ? std::clamp(quota, size_t(1), size() - 2)
+                                           : std::min(quota, size() - 1);
+    mctsFocus     = 0;
+    mctsBestMove  = 0;
+    lastMctsFocus = 0;
+}
+
+// Called by the main thread after every iteration to move one helper towards
+// the search that pays off. Alpha-beta does while its recent iterations still
+// change the best move; MCTS does while its visits keep concentrating on one
+// root move, or when it settled on another move than alpha-beta. The quota stays
+// within [1, size() - 2], and nothing moves while both or none pay off.
+void ThreadPool::rebalance_mcts(Move abBestMove, bool abImproving) {
+
+    const int  focus = mctsFocus.load(std::memory_order_relaxed);
+    const bool mctsImproving =
+      focus - lastMctsFocus >= 20 || (focus >= 500 && Move(mctsBestMove) != abBestMove);
+
+    lastMctsFocus = focus;
+
+    size_t quota = mctsQuota.load(std::memory_order_relaxed);
+
+    if (mctsImproving && !abImproving && quota + 2 < size())
+        ++quota;
+    else if (abImproving && !mctsImproving && quota > 1)
+        --quota;
+    else
+        return;
+
+    mctsQuota = quota;
+
+#if !defined(NDEBUG) && !defined(_NDEBUG)
+    sync_cout << "info string *** " << quota << " threads on MCTS, focus " << focus
+              << sync_endl;
+#endif
+}
+
 Thread* ThreadPool::get_best_thread() const {
 
     Thread* bestThread = threads.front();
@@ -219,9 +480,11 @@ Thread* ThreadPool::get_best_thread() const {
     std::unordered_map<Move, int64_t, Move::MoveHash> votes(
       2 * std::min(size(), bestThread->worker->rootMoves.size()));
 
-    // Find the minimum score of all threads
+    // Find the minimum score of all threads. Threads that pondered on a reply
+    // that was not played have another root, and take no part in the choice.
     for (Thread* th : threads)
-        minScore = std::min(minScore, th->worker->rootMoves[0].score);
+        if (!th->worker->ponderGroup)
+            minScore = std::min(minScore, th->worker->rootMoves[0].score);
 
     // Vote according to score and depth, and select the best thread
     auto thread_voting_value = [minScore](Thread* th) {
@@ -229,10 +492,14 @@ Thread* ThreadPool::get_best_thread() const {
     };
 
     for (Thread* th : threads)
-        votes[th->worker->rootMoves[0].pv[0]] += thread_voting_value(th);
+        if (!th->worker->ponderGroup)
+            votes[th->worker->rootMoves[0].pv[0]] += thread_voting_value(th);
 
     for (Thread* th : threads)
     {
+        if (th->worker->ponderGroup)
+            continue;
+
         const auto bestThreadScore = bestThread->worker->rootMoves[0].score;
         const auto newThreadScore  = th->worker->rootMoves[0].score;
 
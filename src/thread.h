@@ -23,8 +23,10 @@
 #include <condition_variable>
 #include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <mutex>
+#include <string>
 #include <vector>
 
 #include "position.h"
@@ -49,6 +51,7 @@ class Thread {
     void   idle_loop();
     void   start_searching();
     void   wait_for_search_finished();
+    void   run_custom_job(std::function<void()> f);
     size_t id() const { return idx; }
 
     std::unique_ptr<Search::Worker> worker;
@@ -58,6 +61,7 @@ class Thread {
     std::condition_variable cv;
     size_t                  idx, nthreads;
     bool                    exit = false, searching = true;  // Set before starting std::thread
+    std::function<void()>   jobFunc;
     NativeThread            stdThread;
 };
 
@@ -83,6 +87,13 @@ class ThreadPool {
     start_thinking(const OptionsMap&, Position&, StateListPtr&, Search::LimitsType, bool = false);
     void clear();
     void set(Search::SharedState);
+    void ponderhit();
+    void join_main_search(Search::Worker&);
+    void init_mcts(size_t quota, bool dynamic);
+    void rebalance_mcts(Move abBestMove, bool abImproving);
+    bool runs_mcts(size_t idx) const {
+        return idx && idx <= mctsQuota.load(std::memory_order_relaxed);
+    }
 
     Search::SearchManager* main_manager() const {
         return static_cast<Search::SearchManager*>(main_thread()->worker.get()->manager.get());
@@ -96,6 +107,15 @@ class ThreadPool {
 
     std::atomic_bool stop, abortedSearch, increaseDepth;
 
+    // Kelly: the learning table is probed during a search, and the next one
+    // keeps probing it only if a learned move was found.
+    std::atomic_bool useLearning{true}, enabledLearningProbe{false};
+
+    // Published by the MCTS threads: the share of the root visits, in permille,
+    // that went to the most visited root move, and that move.
+    std::atomic<int>      mctsFocus;
+    std::atomic<uint16_t> mctsBestMove;
+
     auto cbegin() const noexcept { return threads.cbegin(); }
     auto begin() noexcept { return threads.begin(); }
     auto end() noexcept { return threads.end(); }
@@ -107,6 +127,23 @@ class ThreadPool {
     StateListPtr         setupStates;
     std::vector<Thread*> threads;
 
+    // The root of the last search, as given to the main thread
+    std::string       rootFen;
+    Search::RootMoves rootMoves;
+    Bitbases::Config  tbConfig;
+
+    // When pondering on several replies, the threads from ponderSplit to the
+    // end of the pool search the replies other than the expected one.
+    bool   pondering   = false;
+    size_t ponderSplit = 0;
+
+    void split_ponder(const OptionsMap&, Position&, const Search::LimitsType&);
+
+    // The helpers from 1 to mctsQuota run the Monte-Carlo search, the others
+    // alpha-beta. The main thread moves the boundary during the search.
+    std::atomic<size_t> mctsQuota;
+    int                 lastMctsFocus = 0;
+
     uint64_t accumulate(std::atomic<uint64_t> Search::Worker::*member) const {
 
         uint64_t sum = 0;
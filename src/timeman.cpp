@@ -22,6 +22,7 @@
 #include <cassert>
 #include <cmath>
 #include <cstdint>
+#include <sstream>
 
 #include "search.h"
 #include "ucioption.h"
@@ -37,6 +38,15 @@ TimePoint TimeManagement::elapsed(size_t nodes) const {
 
 void TimeManagement::clear() {
     availableNodes = 0;  // When in 'nodes as time' mode
+    lastUs         = COLOR_NB;
+}
+
+void TimeManagement::Average::add(double x) {
+
+    constexpr double Alpha = 0.2;
+
+    dev  = count++ ? (1 - Alpha) * dev + Alpha * std::abs(x - mean) : 0.0;
+    mean = count > 1 ? (1 - Alpha) * mean + Alpha * x : x;
 }
 
 void TimeManagement::advance_nodes_time(std::int64_t nodes) {
@@ -62,9 +72,32 @@ void TimeManagement::init(Search::LimitsType& limits,
     }
     TimePoint minThinkingTime = TimePoint(options["Minimum Thinking Time"]);
     //minThinkigTime end
-    TimePoint moveOverhead = TimePoint(options["Move Overhead"]);
-    TimePoint slowMover    = TimePoint(options["Slow Mover"]);  //for SlowMover
-    TimePoint npmsec       = TimePoint(options["nodestime"]);
+    TimePoint slowMover = TimePoint(options["Slow Mover"]);  //for SlowMover
+    TimePoint npmsec    = TimePoint(options["nodestime"]);
+
+    moveOverhead = TimePoint(options["Move Overhead"]);
+
+    // Our clock should have been reduced by the time we used on our previous
+    // move, any difference is the latency of the GUI. A clock that grew more
+    // than the increment starts a new time control, and is not a measurement.
+    if (lastUs == us && !npmsec)
+    {
+        const TimePoint lost = lastTime + lastInc - limits.time[us] - lastUsed;
+
+        if (lost >= -100 && lost < lastTime)
+            lag.add(double(std::max(lost, TimePoint(0))));
+    }
+
+    // The remaining moves will lose the mean latency and overrun each, which is
+    // set aside from the budget. Only the current move has to be safe from the
+    // worst case, so the bounds, which grow with the spread, cap its maximum.
+    moveReserve = moveOverhead;
+
+    if (options["Adaptive Time"] && lag.count && !npmsec)
+    {
+        moveReserve  = std::max(moveOverhead, TimePoint(lag.mean + overrun.mean + 0.5));
+        moveOverhead = std::max(moveOverhead, TimePoint(lag.bound() + overrun.bound() + 0.5));
+    }
 
     // optScale is a percentage of available time to use for the current move.
     // maxScale is a multiplier applied to optimumTime.
@@ -92,7 +125,7 @@ void TimeManagement::init(Search::LimitsType& limits,
 
     // Make sure timeLeft is > 0 since we may use it as a divisor
     TimePoint timeLeft = std::max(TimePoint(1), limits.time[us] + limits.inc[us] * (mtg - 1)
-                                                  - moveOverhead * (2 + mtg));
+                                                  - moveReserve * (2 + mtg));
     //from SlowMover begin
     // A user may scale time usage by setting UCI option "Slow Mover"
     // Default is 100 and changing this value will probably lose elo.
@@ -134,4 +167,49 @@ void TimeManagement::init(Search::LimitsType& limits,
         optimumTime += optimumTime / 4;
 }
 
+void TimeManagement::record(const Search::LimitsType& limits,
+                            Color                     us,
+                            std::size_t               nodes,
+                            bool                      ponder) {
+
+    const TimePoint used = now() - startTime;
+
+    lastUs = COLOR_NB;
+
+    if (!limits.time[us] || useNodesTime)
+        return;
+
+    if (used >= 10)
+        nps.add(nodes * 1000.0 / used);
+
+    overrun.add(double(std::max(used - maximumTime, TimePoint(0))));
+
+    // After a ponder search, the clock of the GUI started at the ponderhit
+    if (!ponder)
+    {
+        lastTime = limits.time[us];
+        lastInc  = limits.inc[us];
+        lastUsed = used;
+        lastUs   = us;
+    }
+}
+
+std::string TimeManagement::telemetry() {
+
+    std::stringstream ss;
+
+    ss << "reserve " << moveReserve << " overhead " << moveOverhead << " lag "
+       << TimePoint(lag.mean) << "+/-" << TimePoint(lag.dev) << " overrun "
+       << TimePoint(overrun.mean) << "+/-" << TimePoint(overrun.dev);
+
+    if (ss.str() == lastTelemetry)
+        return {};
+
+    lastTelemetry = ss.str();
+
+    return "time optimum " + std::to_string(optimumTime) + " maximum "
+         + std::to_string(maximumTime) + " " + lastTelemetry + " nps "
+         + std::to_string(uint64_t(nps.mean));
+}
+
 }  // namespace Brainlearn
@@ -21,6 +21,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <string>
 
 #include "misc.h"
 #include "types.h"
@@ -45,13 +46,42 @@ class TimeManagement {
     void clear();
     void advance_nodes_time(std::int64_t nodes);
 
+    // Called once the best move is sent, to learn the latency of the GUI and
+    // the speed of this host from the timed searches
+    void record(const Search::LimitsType& limits, Color us, std::size_t nodes, bool ponder);
+
+    // Returns the learned figures when they changed since the last call, else
+    // an empty string
+    std::string telemetry();
+
    private:
+    // Exponentially weighted mean and mean deviation of a measurement
+    struct Average {
+        double mean = 0.0, dev = 0.0;
+        int    count = 0;
+
+        void   add(double x);
+        double bound() const { return mean + 3 * dev; }
+    };
+
     TimePoint startTime;
     TimePoint optimumTime;
     TimePoint maximumTime;
+    TimePoint moveOverhead = 0;  // Effective overhead of the current search
+    TimePoint moveReserve  = 0;  // Time set aside for each of the remaining moves
 
     std::int64_t availableNodes = 0;      // When in 'nodes as time' mode
     bool         useNodesTime   = false;  // True if we are in 'nodes as time' mode
+
+    // The measurements depend on the host and the GUI rather than on the game,
+    // so they are kept across games. 'lag' is the clock time lost between our
+    // best move and the next "go", and 'overrun' the search time past the
+    // maximum, which grows with the CPU steal time.
+    Average   lag, overrun, nps;
+    TimePoint lastTime = 0, lastInc = 0, lastUsed = 0;
+    Color     lastUs   = COLOR_NB;  // Side of the previous timed search, if it can be used
+
+    std::string lastTelemetry;  // Learned figures last reported
 };
 
 }  // namespace Brainlearn
@@ -18,6 +18,7 @@
 
 #include "tt.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstdlib>
 #include <cstring>
@@ -25,6 +26,7 @@
 #include <thread>
 #include <vector>
 
+#include "memory.h"
 #include "misc.h"
 
 namespace Brainlearn {
@@ -57,6 +59,7 @@ void TTEntry::save(
 // measured in megabytes. Transposition table consists of a power of 2 number
 // of clusters and each cluster consists of ClusterSize number of TTEntry.
 void TranspositionTable::resize(size_t mbSize, int threadCount) {
+    Memory::untrack(table);
     aligned_large_pages_free(table);
 
     clusterCount = mbSize * 1024 * 1024 / sizeof(Cluster);
@@ -68,6 +71,8 @@ void TranspositionTable::resize(size_t mbSize, int threadCount) {
         exit(EXIT_FAILURE);
     }
 
+    Memory::track(Memory::TT, table, clusterCount * sizeof(Cluster));
+
     clear(threadCount);
 }
 
@@ -149,4 +154,120 @@ int TranspositionTable::hashfull() const {
     return cnt / ClusterSize;
 }
 
+
+// Looks up the position in the cache, and in the shared table when it is not
+// there or the node is too deep to be cached. The returned entry is to be
+// written with TTCache::save().
+TTEntry* TTCache::probe(const Key key, Depth depth, bool& found) {
+
+    if (slots.empty())
+        return tt.probe(key, found);
+
+    Slot& s = slot(key);
+
+    // A deep node also sees the results of the shallow ones
+    if (depth > MaxDepth)
+    {
+        if (s.key == key)
+        {
+            write_back(s);
+            s = Slot{};
+        }
+
+        return tt.probe(key, found);
+    }
+
+    if (s.key == key && s.entry.depth8)
+        return found = true, &s.entry;
+
+    write_back(s);
+
+    const TTEntry* tte = tt.probe(key, found);
+
+    s.key   = key;
+    s.entry = found ? *tte : TTEntry{};
+    s.dirty = false;
+
+    return &s.entry;
+}
+
+
+// Saves into an entry returned by probe(), and writes through to the shared
+// table according to the rules above
+void TTCache::save(TTEntry* tte, Key k, Value v, bool pv, Bound b, Depth d, Move m, Value ev) {
+
+    const uint8_t generation8 = tt.generation();
+
+    if (slots.empty() || tte != &slot(k).entry)
+    {
+        tte->save(k, v, pv, b, d, m, ev, generation8);
+        return;
+    }
+
+    Slot& s = slot(k);
+
+    // The slot has been taken by another position below this node
+    if (s.key != k)
+    {
+        write_back(s);
+        s.key   = k;
+        s.entry = TTEntry{};
+    }
+
+    tte->save(k, v, pv, b, d, m, ev, generation8);
+
+    if (b == BOUND_EXACT || pv || d > MaxDepth)
+    {
+        bool found;
+        tt.probe(k, found)->save(k, v, pv, b, d, m, ev, generation8);
+        s.dirty = false;
+    }
+    else
+        s.dirty = true;
+}
+
+
+void TTCache::write_back(Slot& s) {
+
+    if (!s.dirty)
+        return;
+
+    bool           found;
+    const TTEntry& e = s.entry;
+
+    tt.probe(s.key, found)
+      ->save(s.key, e.value(), e.is_pv(), e.bound(), e.depth(), e.move(), e.eval(), tt.generation());
+    s.dirty = false;
+}
+
+
+// Sets the size of the cache in bytes, rounded down to a power of two number
+// of entries. A zero size disables it.
+void TTCache::resize(size_t bytes) {
+
+    size_t count = bytes / sizeof(Slot);
+
+    while (count & (count - 1))
+        count &= count - 1;
+
+    if (count == slots.size())
+        return;
+
+    Memory::add(Memory::TT, (int64_t(count) - int64_t(slots.size())) * int64_t(sizeof(Slot)));
+    slots = std::vector<Slot>(count);
+}
+
+
+// Writes the pending results to the shared table and empties the cache
+void TTCache::flush() {
+
+    for (Slot& s : slots)
+        write_back(s);
+
+    clear();
+}
+
+
+void TTCache::clear() { std::fill(slots.begin(), slots.end(), Slot{}); }
+
 }  // namespace Brainlearn
@@ -21,7 +21,9 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <vector>
 
+#include "memory.h"
 #include "misc.h"
 #include "types.h"
 
@@ -49,6 +51,7 @@ struct TTEntry {
 
    private:
     friend class TranspositionTable;
+    friend class TTCache;
 
     uint16_t key16;
     uint8_t  depth8;
@@ -84,12 +87,18 @@ class TranspositionTable {
       (0xFF << GENERATION_BITS) & 0xFF;  // mask to pull out generation number
 
    public:
-    ~TranspositionTable() { aligned_large_pages_free(table); }
+    ~TranspositionTable() {
+        Memory::untrack(table);
+        aligned_large_pages_free(table);
+    }
     void new_search() { generation8 += GENERATION_DELTA; }  // Lower bits are used for other things
     TTEntry* probe(const Key key, bool& found) const;
     int      hashfull() const;
     void     resize(size_t mbSize, int threadCount);
     void     clear(size_t threadCount);
+    bool     has_size(size_t mbSize) const {
+        return table && clusterCount == mbSize * 1024 * 1024 / sizeof(Cluster);
+    }
 
     TTEntry* first_entry(const Key key) const {
         return &table[mul_hi64(key, clusterCount)].entry[0];
@@ -105,6 +114,48 @@ class TranspositionTable {
     uint8_t  generation8 = 0;  // Size must be not bigger than TTEntry::genBound8
 };
 
+
+// A TTCache is a small direct-mapped table of a search thread, in front of the
+// shared TranspositionTable. It serves the nodes of depth up to MaxDepth, which
+// make most of the probes, so that they do not read and refresh the cache lines
+// that the other threads write to. It is kept coherent with the shared table by
+// these rules:
+//  - Its entries are matched on the full key, and filled from the shared table
+//    on a miss. The nodes deeper than MaxDepth use the shared table directly,
+//    after the cached entry of their position is written back and dropped.
+//  - Exact, PV and deep results are written through to the shared table at once.
+//  - The other results are written back when their entry is evicted, and when
+//    the search ends. The cache is emptied then, so it never holds entries of
+//    an older generation.
+class TTCache {
+
+    struct Slot {
+        Key     key = 0;
+        TTEntry entry{};
+        bool    dirty = false;
+    };
+
+   public:
+    static constexpr Depth MaxDepth = 2;
+
+    explicit TTCache(TranspositionTable& transpositionTable) :
+        tt(transpositionTable) {}
+    ~TTCache() { resize(0); }
+
+    TTEntry* probe(const Key key, Depth depth, bool& found);
+    void     save(TTEntry* tte, Key k, Value v, bool pv, Bound b, Depth d, Move m, Value ev);
+    void     resize(size_t bytes);
+    void     flush();
+    void     clear();
+
+   private:
+    Slot& slot(const Key key) { return slots[key & (slots.size() - 1)]; }
+    void  write_back(Slot& s);
+
+    TranspositionTable& tt;
+    std::vector<Slot>   slots;
+};
+
 }  // namespace Brainlearn
 
 #endif  // #ifndef TT_H_INCLUDED
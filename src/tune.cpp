@@ -30,10 +30,11 @@ using std::string;
 
 namespace Brainlearn {
 
-bool                              Tune::update_on_last;
-const Option*                     LastOption = nullptr;
-OptionsMap*                       Tune::options;
-static std::map<std::string, int> TuneResults;
+bool                                Tune::update_on_last;
+const Option*                       LastOption = nullptr;
+OptionsMap*                         Tune::options;
+static std::map<std::string, int>   TuneResults;
+static std::map<std::string, Range> TuneRanges;
 
 string Tune::next(string& names, bool pop) {
 
@@ -70,7 +71,8 @@ static void make_option(OptionsMap* options, const string& n, int v, const SetRa
         v = TuneResults[n];
 
     (*options)[n] << Option(v, r(v).first, r(v).second, on_tune);
-    LastOption = &((*options)[n]);
+    LastOption    = &((*options)[n]);
+    TuneRanges[n] = r(v);
 
     // Print formatted parameters, ready to be copy-pasted in Fishtest
     std::cout << n << "," << v << "," << r(v).first << "," << r(v).second << ","
@@ -97,6 +99,17 @@ void Tune::Entry<Tune::PostUpdate>::read_option() {
     value();
 }
 
+std::vector<Tune::Parameter> Tune::parameters() {
+
+    std::vector<Parameter> params;
+
+    for (auto& e : instance().list)
+        if (auto p = dynamic_cast<Entry<int>*>(e.get()); p && TuneRanges.count(p->name))
+            params.push_back({p->name, p->value, TuneRanges[p->name]});
+
+    return params;
+}
+
 }  // namespace Brainlearn
 
 
@@ -107,7 +120,8 @@ void Tune::Entry<Tune::PostUpdate>::read_option() {
 //
 // cat results.txt | sed 's/^param: \([^,]*\), best: \([^,]*\).*/  TuneResults["\1"] = int(round(\2));/'
 //
-// Then paste the output below, as the function body
+// Then paste the output below, as the function body. The local 'spsa' command
+// prints its final values in the same form.
 
 
 namespace Brainlearn {
@@ -163,6 +163,15 @@ class Tune {
             e->read_option();
     }
 
+    // A parameter exposed as a UCI option, with its current value and range
+    struct Parameter {
+        std::string name;
+        int         value;
+        Range       range;
+    };
+
+    static std::vector<Parameter> parameters();
+
     static bool        update_on_last;
     static OptionsMap* options;
 };
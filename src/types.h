@@ -35,6 +35,10 @@
 //
 // -DUSE_PEXT    | Add runtime support for use of pext asm-instruction. Works
 //               | only in 64-bit mode and requires hardware with pext support.
+//
+// -DCHESS_GENERIC | Keep the chess machinery inherited from Stockfish (Chess960,
+//                 | castling rights in FENs, promotions searched as captures,
+//                 | diagonal sliders). Without it the engine is Makruk only.
 
     #include <cassert>
     #include <cstdint>
@@ -102,6 +106,12 @@ constexpr bool Is64Bit = true;
 constexpr bool Is64Bit = false;
     #endif
 
+    #ifdef CHESS_GENERIC
+constexpr bool MakrukOnly = false;
+    #else
+constexpr bool MakrukOnly = true;
+    #endif
+
 using Key      = uint64_t;
 using Bitboard = uint64_t;
 
@@ -32,12 +32,17 @@
 
 #include "benchmark.h"
 #include "evaluate.h"
+#include "memory.h"
 #include "movegen.h"
 #include "nnue/evaluate_nnue.h"
 #include "nnue/nnue_architecture.h"
 #include "position.h"
 #include "search.h"
-// #include "syzygy/tbprobe.h"
+#include "bitbase/bitbase.h"
+#include "analysis/analysis.h"
+#include "selfplay/gensfen.h"
+#include "selfplay/selfplay.h"
+#include "selfplay/spsa.h"
 #include "types.h"
 #include "ucioption.h"
 #include "perft.h"
@@ -54,7 +59,8 @@ constexpr auto StartFEN = "rnsmksnr/8/pppppppp/8/8/PPPPPPPP/8/RNSKMSNR w 0 1";
 constexpr int MaxHashMB = Is64Bit ? 33554432 : 2048;
 
 UCI::UCI(int argc, char** argv) :
-    cli(argc, argv) {
+    cli(argc, argv),
+    lastMove(Move::none()) {
 
     evalFiles = {{Eval::NNUE::Big, {"EvalFile", EvalFileDefaultNameBig, "None", ""}},
                  {Eval::NNUE::Small, {"EvalFileSmall", EvalFileDefaultNameSmall, "None", ""}}};
@@ -71,15 +77,20 @@ UCI::UCI(int argc, char** argv) :
         tt.resize(o, options["Threads"]);
     });
 
+    options["Thread Hash"] << Option(0, 0, 4096);  // KB per thread, 0 = off
     options["Clear Hash"] << Option([this](const Option&) { search_clear(); });
+    options["Memory Report"] << Option(0, 0, 3600);  // Seconds between reports, 0 = off
     options["Ponder"] << Option(false);
+    options["Ponder Candidates"] << Option(1, 1, 8);
     options["MultiPV"] << Option(1, 1, MAX_MOVES);
     options["Skill Level"] << Option(20, 0, 20);
     options["Move Overhead"] << Option(10, 0, 5000);
     options["Minimum Thinking Time"] << Option(100, 0, 5000);  //minimum thining time
     options["Slow Mover"] << Option(100, 10, 1000);            //slow mover
     options["nodestime"] << Option(0, 0, 10000);
-    options["UCI_Chess960"] << Option(false);
+    options["Adaptive Time"] << Option(true);
+    if constexpr (!MakrukOnly)
+        options["UCI_Chess960"] << Option(false);
     options["UCI_Variant"] << Option("makruk", {"makruk"});
     options["UCI_LimitStrength"] << Option(false);
     options["UCI_Elo"] << Option(1320, 1320, 3190);
@@ -94,16 +105,19 @@ UCI::UCI(int argc, char** argv) :
         options[Util::format_string("(CTG) Book %d Only Green", i + 1)] << Option(true);
     }
     //Book management end
-    // options["SyzygyPath"] << Option("<empty>", [](const Option& o) { Tablebases::init(o); });
-    // options["SyzygyProbeDepth"] << Option(1, 1, 100);
-    // options["Syzygy50MoveRule"] << Option(true);
-    // options["SyzygyProbeLimit"] << Option(7, 0, 7);
+    options["BitbasePath"] << Option("<empty>", [](const Option& o) { Bitbases::init(o); });
+    options["BitbaseProbeDepth"] << Option(1, 1, 100);
+    options["BitbaseCounting"] << Option(true);
+    options["BitbaseProbeLimit"] << Option(5, 0, 5);
     options["EvalFile"] << Option(EvalFileDefaultNameBig, [this](const Option&) {
         evalFiles = Eval::NNUE::load_networks(cli.binaryDirectory, options, evalFiles);
     });
     options["EvalFileSmall"] << Option(EvalFileDefaultNameSmall, [this](const Option&) {
         evalFiles = Eval::NNUE::load_networks(cli.binaryDirectory, options, evalFiles);
     });
+    options["Cascaded Eval"] << Option(false);
+    options["Cascaded Eval Margin"] << Option(250, 0, 2000);
+    options["Cascaded Eval Complexity"] << Option(400, 0, 10000);
     //From Kelly begin
     options["Read only learning"] << Option(false, [this](const Option& o) { LD.set_readonly(o); });
     options["Self Q-learning"] << Option(false, [this](const Option& o) {
@@ -115,6 +129,7 @@ UCI::UCI(int argc, char** argv) :
     options["MCTSThreads"] << Option(1, 1, 512);
     options["MCTS Multi Strategy"] << Option(20, 0, 100);
     options["MCTS Multi MinVisits"] << Option(5, 0, 1000);
+    options["MCTS Dynamic Threads"] << Option(true);
     //From MCTS end
     //livebook begin
 #ifdef USE_LIVEBOOK
@@ -136,6 +151,11 @@ UCI::UCI(int argc, char** argv) :
     options["Opening variety"] << Option(0, 0, 40);  //Opening discoverer
     options["Concurrent Experience"]
       << Option(false);  //for a same experience file on a same folder
+    options["Analysis Cache"] << Option(false, [this](const Option&) { Analysis::init(options); });
+    options["Analysis Cache File"]
+      << Option("analysis.bin", [this](const Option&) { Analysis::init(options); });
+    options["Analysis Cache Entries"]
+      << Option(100000, 1, 10000000, [this](const Option&) { Analysis::init(options); });
     threads.set({bookMan, evalFiles, options, threads, tt});
 
     search_clear();  // After threads are up
@@ -192,7 +212,7 @@ void UCI::loop() {
         // has played. The search should continue, but should also switch from pondering
         // to the normal search.
         else if (token == "ponderhit")
-            threads.main_manager()->ponder = false;  // Switch to the normal search
+            threads.ponderhit();  // Switch to the normal search
 
         else if (token == "uci")
             sync_cout << "id name " << engine_info(true) << "\n"
@@ -231,15 +251,30 @@ void UCI::loop() {
         // Add custom non-UCI commands, mainly for debugging purposes.
         // These commands must not be used during a search!
         else if (token == "flip")
+        {
             pos.flip();
+            lastMove = Move::none();
+        }
         else if (token == "bench")
             bench(pos, is, states);
         else if (token == "d")
             sync_cout << pos << sync_endl;
+        else if (token == "memory")
+            sync_cout << Memory::report() << sync_endl;
         else if (token == "eval")
             trace_eval(pos);
         else if (token == "book")
             bookMan.show_moves(pos, options);
+        else if (token == "bitbase")
+            bitbase(is);
+        else if (token == "mcts")
+            mcts(is);
+        else if (token == "selfplay")
+            selfplay(is);
+        else if (token == "gensfen")
+            gensfen(is);
+        else if (token == "spsa")
+            spsa(is);
         else if (token == "compiler")
             sync_cout << compiler_info() << sync_endl;
         else if (token == "export_net")
@@ -249,6 +284,10 @@ void UCI::loop() {
             if (is >> std::skipws >> f)
                 filename = f;
             Eval::NNUE::save_eval(filename, Eval::NNUE::Big, evalFiles);
+
+            // The small net is only exported when a file name is given for it
+            if (is >> std::skipws >> f)
+                Eval::NNUE::save_eval(f, Eval::NNUE::Small, evalFiles);
         }
         else if (token == "--help" || token == "help" || token == "--license" || token == "license")
             sync_cout
@@ -304,14 +343,17 @@ void UCI::go(Position& pos, std::istringstream& is, StateListPtr& states) {
         else if (token == "ponder")
             ponderMode = true;
 
-    Eval::NNUE::verify(options, evalFiles);
+    if (ponderMode)
+        limits.ponderMove = lastMove;
 
     if (limits.perft)
     {
-        perft(pos.fen(), limits.perft, options["UCI_Chess960"]);
+        perft(pos.fen(), limits.perft, pos.is_chess960());
         return;
     }
 
+    Eval::NNUE::verify(options, evalFiles);
+
     threads.start_thinking(options, pos, states, limits, ponderMode);
 }
 
@@ -377,7 +419,7 @@ void UCI::bench(Position& pos, std::istream& args, StateListPtr& states) {
 void UCI::trace_eval(Position& pos) {
     StateListPtr states(new std::deque<StateInfo>(1));
     Position     p;
-    p.set(pos.fen(), options["UCI_Chess960"], &states->back());
+    p.set(pos.fen(), pos.is_chess960(), &states->back());
 
     Eval::NNUE::verify(options, evalFiles);
 
@@ -395,7 +437,7 @@ void UCI::search_clear() {
     tt.clear(options["Threads"]);
     MCTS.clear();  // mcts
     threads.clear();
-    // Tablebases::init(options["SyzygyPath"]);  // Free mapped files
+    Bitbases::init(options["BitbasePath"]);  // Free mapped files
 }
 
 void UCI::setoption(std::istringstream& is) {
@@ -403,6 +445,269 @@ void UCI::setoption(std::istringstream& is) {
     options.setoption(is);
 }
 
+// Generates Makruk bitbases, for instance "bitbase /path/to/dir 4" writes all
+// the tables up to four pieces and "bitbase /path/to/dir KRvK KSMvK" only the
+// given ones (together with their sub-tables). Uses the "Threads" option.
+void UCI::bitbase(std::istringstream& is) {
+    threads.main_thread()->wait_for_search_finished();
+
+    std::string              path, token;
+    std::vector<std::string> signatures;
+
+    is >> path;
+    while (is >> token)
+        signatures.push_back(token);
+
+    if (path.empty() || signatures.empty())
+    {
+        sync_cout << "info string Usage: bitbase <directory> <pieces|signature...>" << sync_endl;
+        return;
+    }
+
+    if (Bitbases::generate(path, signatures, options["Threads"]))
+        Bitbases::init(options["BitbasePath"]);  // Map the new files
+}
+
+// Saves or loads the Monte-Carlo tree, "mcts save tree.bin" and "mcts load
+// tree.bin". A loaded tree replaces the current one, so it has to be loaded
+// after 'ucinewgame', which clears it. Loading uses the "Threads" option.
+void UCI::mcts(std::istringstream& is) {
+    threads.main_thread()->wait_for_search_finished();
+
+    std::string action, file;
+    is >> action >> file;
+
+    if ((action != "save" && action != "load") || file.empty())
+    {
+        sync_cout << "info string Usage: mcts save|load <file>" << sync_endl;
+        return;
+    }
+
+    const bool ok = action == "save" ? save_tree(file) : load_tree(file, size_t(options["Threads"]));
+
+    if (!ok)
+        sync_cout << "info string Failed to " << action << " " << file << sync_endl;
+    else
+        sync_cout << "info string MCTS tree of " << MCTS.size() << " nodes "
+                  << (action == "save" ? "saved to " : "loaded from ") << file << sync_endl;
+}
+
+// Plays a match between two players that share the current options, except for
+// the ones given after 'a' and 'b' with the same syntax as 'setoption'. Example:
+// selfplay games 1000 concurrency 8 tc 10+0.1 openings book.epd pgn out.pgn
+//          sprt 0 5 a name MCTS value true
+void UCI::selfplay(std::istringstream& is) {
+    threads.main_thread()->wait_for_search_finished();
+
+    SelfPlay::Config config;
+    std::string      token;
+
+    while (is >> token)
+        if (token == "games")
+            is >> config.games;
+        else if (token == "concurrency")
+            is >> config.concurrency;
+        else if (token == "tc")
+        {
+            double base = 0, inc = 0;
+            char   plus;
+            is >> base;
+            if (is.peek() == '+')
+                is >> plus >> inc;
+            config.time = TimePoint(base * 1000);
+            config.inc  = TimePoint(inc * 1000);
+        }
+        else if (token == "depth")
+            is >> config.depth;
+        else if (token == "nodes")
+            is >> config.nodes;
+        else if (token == "openings")
+            is >> config.openings;
+        else if (token == "pgn")
+            is >> config.pgn;
+        else if (token == "sprt")
+            config.sprt = bool(is >> config.elo0 >> config.elo1);
+        else if (token == "alpha")
+            is >> config.alpha;
+        else if (token == "beta")
+            is >> config.beta;
+        else if (token == "a" || token == "b")
+        {
+            const int   side = token == "a" ? 0 : 1;
+            std::string name, value;
+
+            is >> token;  // Consume the "name" token
+            while (is >> token && token != "value")
+                name += (name.empty() ? "" : " ") + token;
+            is >> value;
+
+            if (!options.count(name))
+            {
+                sync_cout << "info string No such option: " << name << sync_endl;
+                return;
+            }
+
+            // The networks are loaded process-wide, so both players would still
+            // evaluate with the ones of the engine
+            const CaseInsensitiveLess less;
+            for (const std::string net : {"EvalFile", "EvalFileSmall"})
+                if (!less(name, net) && !less(net, name))
+                {
+                    sync_cout << "info string " << net
+                              << " cannot differ between the players, the networks are shared"
+                              << sync_endl;
+                    return;
+                }
+
+            config.options[side].emplace_back(name, value);
+        }
+        else
+        {
+            sync_cout << "info string Unknown selfplay parameter: " << token << sync_endl;
+            return;
+        }
+
+    Eval::NNUE::verify(options, evalFiles);
+
+    SelfPlay::run(config, options, evalFiles);
+}
+
+// Generates training data for the networks from randomized selfplay games, or
+// converts a training data file to plain text. Examples:
+// gensfen count 10000000 depth 8 concurrency 64 output data.bin quiet
+// gensfen convert data.bin data.txt
+void UCI::gensfen(std::istringstream& is) {
+    threads.main_thread()->wait_for_search_finished();
+
+    SelfPlay::GenConfig config;
+    std::string         token;
+
+    config.concurrency = int(options["Threads"]);
+
+    while (is >> token)
+        if (token == "convert")
+        {
+            std::string input, output;
+            is >> input >> output;
+
+            if (!SelfPlay::convert_to_plain(input, output))
+                sync_cout << "info string Cannot convert " << input << " to " << output
+                          << sync_endl;
+            return;
+        }
+        else if (token == "count")
+            is >> config.count;
+        else if (token == "concurrency")
+            is >> config.concurrency;
+        else if (token == "depth")
+            is >> config.depth;
+        else if (token == "nodes")
+            is >> config.nodes;
+        else if (token == "hash")
+            is >> config.hash;
+        else if (token == "output")
+            is >> config.output;
+        else if (token == "random_moves")
+            is >> config.randomMoves;
+        else if (token == "random_ply")
+            is >> config.randomPly;
+        else if (token == "write_minply")
+            is >> config.writeMinPly;
+        else if (token == "eval_limit")
+            is >> config.evalLimit;
+        else if (token == "seed")
+            is >> config.seed;
+        else if (token == "no_checks")
+            config.noChecks = true;
+        else if (token == "no_captures")
+            config.noCaptures = true;
+        else if (token == "quiet")
+            config.quiet = true;
+        else
+        {
+            sync_cout << "info string Unknown gensfen parameter: " << token << sync_endl;
+            return;
+        }
+
+    Eval::NNUE::verify(options, evalFiles);
+
+    SelfPlay::generate(config, options, evalFiles);
+}
+
+// Tunes the parameters registered with TUNE() by SPSA, playing game pairs
+// between child engines. Examples:
+// spsa iterations 20000 concurrency 32 tc 5+0.05 checkpoint spsa.txt
+// spsa iterations 20000 depth 8 resume option name Hash value 64
+void UCI::spsa(std::istringstream& is) {
+    threads.main_thread()->wait_for_search_finished();
+
+    SelfPlay::SpsaConfig config;
+    std::string          token;
+
+    while (is >> token)
+        if (token == "iterations")
+            is >> config.iterations;
+        else if (token == "concurrency")
+            is >> config.concurrency;
+        else if (token == "tc")
+        {
+            double base = 0, inc = 0;
+            char   plus;
+            is >> base;
+            if (is.peek() == '+')
+                is >> plus >> inc;
+            config.time = TimePoint(base * 1000);
+            config.inc  = TimePoint(inc * 1000);
+        }
+        else if (token == "depth")
+            is >> config.depth;
+        else if (token == "nodes")
+            is >> config.nodes;
+        else if (token == "hash")
+            is >> config.hash;
+        else if (token == "random_ply")
+            is >> config.randomPly;
+        else if (token == "openings")
+            is >> config.openings;
+        else if (token == "checkpoint")
+            is >> config.checkpoint;
+        else if (token == "interval")
+            is >> config.interval;
+        else if (token == "resume")
+            config.resume = true;
+        else if (token == "alpha")
+            is >> config.alpha;
+        else if (token == "gamma")
+            is >> config.gamma;
+        else if (token == "A")
+            is >> config.A;
+        else if (token == "r_end")
+            is >> config.rEnd;
+        else if (token == "option")
+        {
+            std::string name, value;
+
+            is >> token;  // Consume the "name" token
+            while (is >> token && token != "value")
+                name += (name.empty() ? "" : " ") + token;
+            is >> value;
+
+            if (!options.count(name))
+            {
+                sync_cout << "info string No such option: " << name << sync_endl;
+                return;
+            }
+            config.options.emplace_back(name, value);
+        }
+        else
+        {
+            sync_cout << "info string Unknown spsa parameter: " << token << sync_endl;
+            return;
+        }
+
+    SelfPlay::spsa(config, cli.argv[0]);
+}
+
 void UCI::position(Position& pos, std::istringstream& is, StateListPtr& states) {
     Move        m;
     std::string token, fen;
@@ -421,7 +726,8 @@ void UCI::position(Position& pos, std::istringstream& is, StateListPtr& states)
         return;
 
     states = StateListPtr(new std::deque<StateInfo>(1));  // Drop the old state and create a new one
-    pos.set(fen, options["UCI_Chess960"], &states->back());
+    pos.set(fen, !MakrukOnly && bool(options["UCI_Chess960"]), &states->back());
+    lastMove = Move::none();
 
     // Parse the move list, if any
     while (is >> token && (m = to_move(pos, token)) != Move::none())
@@ -443,7 +749,10 @@ void UCI::position(Position& pos, std::istringstream& is, StateListPtr& states)
 
         states->emplace_back();
         pos.do_move(m, states->back());
+        lastMove = m;
     }
+
+    Memory::set(Memory::STATES, states->size() * sizeof(StateInfo));
 }
 
 int UCI::to_cp(Value v) { return 100 * v / NormalizeToPawnValue; }
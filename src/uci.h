@@ -65,6 +65,7 @@ class UCI {
     ThreadPool         threads;
     BookManager        bookMan;  //book management
     CommandLine        cli;
+    Move               lastMove;  // Last move of the position, the reply to ponder on
 
     void go(Position& pos, std::istringstream& is, StateListPtr& states);
     void bench(Position& pos, std::istream& args, StateListPtr& states);
@@ -72,6 +73,11 @@ class UCI {
     void trace_eval(Position& pos);
     void search_clear();
     void setoption(std::istringstream& is);
+    void bitbase(std::istringstream& is);
+    void mcts(std::istringstream& is);
+    void selfplay(std::istringstream& is);
+    void gensfen(std::istringstream& is);
+    void spsa(std::istringstream& is);
 };
 
 }  // namespace Brainlearn
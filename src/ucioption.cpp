@@ -64,6 +64,16 @@ Option& OptionsMap::operator[](const std::string& name) { return options_map[nam
 
 std::size_t OptionsMap::count(const std::string& name) const { return options_map.count(name); }
 
+OptionsMap OptionsMap::detached() const {
+
+    OptionsMap copy(*this);
+
+    for (auto& it : copy.options_map)
+        it.second.on_change = nullptr;
+
+    return copy;
+}
+
 Option::Option(const char* v, OnChange f) :
     type("string"),
     min(0),
@@ -44,6 +44,10 @@ class OptionsMap {
 
     std::size_t count(const std::string&) const;
 
+    // Returns a copy of the options without their on_change() actions, for the
+    // engine instances that own their threads and hash table (selfplay, ...)
+    OptionsMap detached() const;
+
    private:
     // The options container is defined as a std::map
     using OptionsStore = std::map<std::string, Option, CaseInsensitiveLess>;
@@ -69,6 +73,7 @@ class Option {
     bool operator==(const char*) const;
 
     friend std::ostream& operator<<(std::ostream&, const OptionsMap&);
+    friend class OptionsMap;
 
    private:
     std::string defaultValue, currentValue, type;